@@ -0,0 +1,345 @@
+// ========================================
+// MICRO-BENCHMARKS OF THE HOT KERNELS
+// ========================================
+
+// Built with Google Benchmark from all sources of the game except main.cpp, whose globals are defined below.
+// Every kernel runs over 1 to 1M inputs, results are printed as JSON, so a run can be kept as a baseline:
+//     kernels --benchmark_out=baseline.json
+// and compared with a later run by compare.py of Google Benchmark.
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "pgr.h"
+#include "headers/camera.h"
+#include "headers/data.h"
+#include "headers/entities.h"
+#include "headers/helpers.h"
+#include "headers/hud.h"
+#include "headers/object.h"
+#include "headers/profiler.h"
+#include "headers/spline.h"
+#include "headers/state.h"
+
+using namespace std;
+using namespace glm;
+
+// ========================================
+// GLOBAL VARIABLES
+// ========================================
+
+// normally defined by main.cpp, the kernels below do not touch most of them
+Camera      *cam         = nullptr;
+State       *state       = nullptr;
+SpatialGrid *grid        = nullptr;
+Heightfield *heightfield = nullptr;
+JobSystem   *jobs        = nullptr;
+EntityStore *entities    = nullptr;
+Profiler    *profiler    = nullptr; // scopes stay off
+RenderStats renderStats;
+
+vector <Object*> stones;
+vector <Object*> hangars;
+vector <Object*> explosions;
+
+Object* tower        = nullptr;
+Object* antenna      = nullptr;
+Object* jetPlane     = nullptr;
+Object* fighterPlane = nullptr;
+Object* retroPlane   = nullptr;
+Object* helicopter   = nullptr;
+Object* gameOver     = nullptr;
+
+bool planeModeOn  = false;
+bool freeCamOn    = false;
+bool flashlightOn = false;
+
+// inputs are the same in every run
+static const unsigned int SEED = 1234u;
+
+// ========================================
+// INPUTS
+// ========================================
+
+/** Sizes from a single entity up to a million of them. */
+static void scaling(benchmark::internal::Benchmark *bench)
+{
+	bench->RangeMultiplier(16)->Range(1, 1 << 20);
+} // SCALING
+
+// ========================================
+
+static vector <float> randomFloats(size_t count, float min, float max)
+{
+	mt19937 random(SEED);
+	uniform_real_distribution <float> dist(min, max);
+
+	vector <float> values(count);
+	for (auto &it : values)
+		it = dist(random);
+
+	return values;
+} // RANDOM FLOATS
+
+// ========================================
+
+static vector <vec3> randomVectors(size_t count, float min, float max)
+{
+	vector <float> values = randomFloats(3 * count, min, max);
+
+	vector <vec3> vectors(count);
+	for (size_t i = 0; i < count; i++)
+		vectors[i] = vec3(values[3 * i], values[3 * i + 1], values[3 * i + 2]);
+
+	return vectors;
+} // RANDOM VECTORS
+
+// ========================================
+
+static void finish(benchmark::State &bench, size_t count)
+{
+	bench.SetItemsProcessed(bench.iterations() * (int64_t)count);
+} // FINISH
+
+// ========================================
+// CURVES
+// ========================================
+
+static void benchEvaluateClosedCurve(benchmark::State &bench)
+{
+	size_t count = (size_t)bench.range(0);
+	vector <float> params = randomFloats(count, 0.0f, (float)helicopterCurveSize);
+
+	for (auto _ : bench)
+		for (float t : params)
+			benchmark::DoNotOptimize(evaluateClosedCurve(helicopterCurveData, helicopterCurveSize, t));
+
+	finish(bench, count);
+} // BENCH EVALUATE CLOSED CURVE
+
+BENCHMARK(benchEvaluateClosedCurve)->Apply(scaling);
+
+// ========================================
+
+static void benchEvaluateClosedCurveDerivative(benchmark::State &bench)
+{
+	size_t count = (size_t)bench.range(0);
+	vector <float> params = randomFloats(count, 0.0f, (float)helicopterCurveSize);
+
+	for (auto _ : bench)
+		for (float t : params)
+			benchmark::DoNotOptimize(evaluateClosedCurve_1stDerivative(helicopterCurveData, helicopterCurveSize, t));
+
+	finish(bench, count);
+} // BENCH EVALUATE CLOSED CURVE DERIVATIVE
+
+BENCHMARK(benchEvaluateClosedCurveDerivative)->Apply(scaling);
+
+// ========================================
+
+static void benchAlignObject(benchmark::State &bench)
+{
+	size_t count = (size_t)bench.range(0);
+	vector <vec3> positions = randomVectors(count, -100.0f, 100.0f);
+	vector <vec3> fronts = randomVectors(count, -1.0f, 1.0f);
+
+	for (auto _ : bench)
+		for (size_t i = 0; i < count; i++)
+			benchmark::DoNotOptimize(alignObject(positions[i], fronts[i], Y_AXIS));
+
+	finish(bench, count);
+} // BENCH ALIGN OBJECT
+
+BENCHMARK(benchAlignObject)->Apply(scaling);
+
+// ========================================
+// COLLISIONS
+// ========================================
+
+/** Player against every object, a part of them is hit. */
+static void benchCheckTrivialCollision(benchmark::State &bench)
+{
+	size_t count = (size_t)bench.range(0);
+	vector <vec3> positions = randomVectors(count, -SCENE_WIDTH / 2.0f, SCENE_WIDTH / 2.0f);
+	vector <vec3> boxes = randomVectors(count, 1.0f, 10.0f);
+	vec3 myPos = vec3(0.0f, 1.0f, 0.0f), myBoundBox = vec3(1.0f);
+
+	for (auto _ : bench)
+		for (size_t i = 0; i < count; i++)
+			benchmark::DoNotOptimize(checkTrivialCollision(myPos, myBoundBox, positions[i], boxes[i]));
+
+	finish(bench, count);
+} // BENCH CHECK TRIVIAL COLLISION
+
+BENCHMARK(benchCheckTrivialCollision)->Apply(scaling);
+
+// ========================================
+
+/** Player against every hangar, the player stands inside some of them. */
+static void benchCheckComplexCollision(benchmark::State &bench)
+{
+	size_t count = (size_t)bench.range(0);
+	vector <vec3> positions = randomVectors(count, -20.0f, 20.0f);
+	vector <vec3> boxes = randomVectors(count, 5.0f, 15.0f);
+	vector <vec3> inBoxes(count);
+	vec3 myPos = vec3(0.0f, 0.5f, 0.0f), myBoundBox = vec3(1.0f);
+
+	for (size_t i = 0; i < count; i++)
+		inBoxes[i] = 0.8f * boxes[i];
+
+	for (auto _ : bench)
+		for (size_t i = 0; i < count; i++)
+			benchmark::DoNotOptimize(checkComplexCollision(myPos, myBoundBox, positions[i], boxes[i], inBoxes[i]));
+
+	finish(bench, count);
+} // BENCH CHECK COMPLEX COLLISION
+
+BENCHMARK(benchCheckComplexCollision)->Apply(scaling);
+
+// ========================================
+// CAMERA AND INPUT
+// ========================================
+
+static void benchCameraUpdateAngle(benchmark::State &bench)
+{
+	size_t count = (size_t)bench.range(0);
+	vector <float> angles = randomFloats(2 * count, -CAMERA_ANGLE_MAX, CAMERA_ANGLE_MAX);
+	vector <Camera> cameras(count, Camera(CAM_DEF_POS, CAM_DEF_DIR, CAM_DEF_UP));
+
+	for (size_t i = 0; i < count; i++)
+	{
+		cameras[i].setAngleX(angles[2 * i]);
+		cameras[i].setAngleY(angles[2 * i + 1]);
+	} // for
+
+	for (auto _ : bench)
+		for (auto &it : cameras)
+		{
+			it.updateAngle();
+			benchmark::DoNotOptimize(it);
+		} // for
+
+	finish(bench, count);
+} // BENCH CAMERA UPDATE ANGLE
+
+BENCHMARK(benchCameraUpdateAngle)->Apply(scaling);
+
+// ========================================
+
+static void benchStateIsPressed(benchmark::State &bench)
+{
+	size_t count = (size_t)bench.range(0);
+	State keys(WIN_WIDTH, WIN_HEIGHT, 18);
+
+	mt19937 random(SEED);
+	vector <int> queries(count);
+	for (auto &it : queries)
+		it = (int)(random() % KEYS_COUNT);
+
+	for (int key = 0; key < KEYS_COUNT; key += 2)
+		keys.setKeys(key, true);
+
+	for (auto _ : bench)
+		for (int key : queries)
+			benchmark::DoNotOptimize(keys.isPressed(key));
+
+	finish(bench, count);
+} // BENCH STATE IS PRESSED
+
+BENCHMARK(benchStateIsPressed)->Apply(scaling);
+
+// ========================================
+// MATRICES
+// ========================================
+
+/** Fills the global store with moving entities for the matrix benchmarks. */
+static void createEntities(size_t count)
+{
+	vector <vec3> positions = randomVectors(count, -100.0f, 100.0f);
+	vector <vec3> angles = randomVectors(count, -180.0f, 180.0f);
+	vector <vec3> sizes = randomVectors(count, 0.5f, 2.0f);
+
+	entities = new EntityStore(count);
+	for (size_t i = 0; i < count; i++)
+		entities->create(nullptr, positions[i], -Z_AXIS, sizes[i], sizes[i], angles[i], 0.0f, 0.0f, 0.0f);
+} // CREATE ENTITIES
+
+// ========================================
+
+/** Batched build of model and normal matrices of all dirty entities (what the simulation does every step), on one thread or on all workers. */
+static void benchUpdateMatrices(benchmark::State &bench)
+{
+	size_t count = (size_t)bench.range(0);
+	bool parallel = (bench.range(1) != 0);
+	createEntities(count);
+	JobSystem *workers = parallel ? new JobSystem() : nullptr;
+
+	for (auto _ : bench)
+	{
+		fill(entities->dirty.begin(), entities->dirty.end(), 1); // everything has moved
+		entities->updateMatrices(workers);
+		benchmark::ClobberMemory();
+	} // for
+
+	finish(bench, count);
+	deleteComponent(&workers);
+	deleteComponent(&entities);
+} // BENCH UPDATE MATRICES
+
+BENCHMARK(benchUpdateMatrices)->ArgNames({"entities", "parallel"})->ArgsProduct({benchmark::CreateRange(1, 1 << 20, 16), {0, 1}});
+
+// ========================================
+
+/** The same matrices built one object at a time by its own transform (objects with a custom one, e.g. the helicopter). */
+static void benchObjectMatrices(benchmark::State &bench)
+{
+	size_t count = (size_t)bench.range(0);
+	vector <vec3> positions = randomVectors(count, -100.0f, 100.0f);
+	vector <vec3> angles = randomVectors(count, -180.0f, 180.0f);
+
+	entities = new EntityStore(count);
+	vector <Object*> objects;
+	for (size_t i = 0; i < count; i++)
+		objects.push_back(new Object(positions[i], -Z_AXIS, vec3(1.0f), vec3(1.0f), angles[i], 0.0f, 0.0f, 0.0f, 0.0f));
+
+	for (auto _ : bench)
+		for (auto it : objects)
+		{
+			entities->dirty[it->getHandle().index] = 1;
+			benchmark::DoNotOptimize(it->getMMatrix());
+		} // for
+
+	finish(bench, count);
+	deleteVector(objects);
+	deleteComponent(&entities);
+} // BENCH OBJECT MATRICES
+
+BENCHMARK(benchObjectMatrices)->Apply(scaling);
+
+// ========================================
+// MAIN
+// ========================================
+
+int main(int argc, char **argv)
+{
+	// JSON unless another format is asked for
+	string format = "--benchmark_format=json";
+	vector <char*> args(argv, argv + argc);
+
+	if (none_of(args.begin(), args.end(), [](char *arg) {return string(arg).rfind("--benchmark_format", 0) == 0;}))
+		args.push_back(&format[0]);
+
+	int count = (int)args.size();
+	benchmark::Initialize(&count, args.data());
+	if (benchmark::ReportUnrecognizedArguments(count, args.data()))
+		return 1;
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	return 0;
+} // MAIN
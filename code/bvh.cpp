@@ -0,0 +1,362 @@
+#include "pgr.h"
+#include "headers/bvh.h"
+
+// ========================================
+
+static const int BINS = 12; // SAH candidates per axis
+static const int LEAF_SIZE = 4; // triangles always stored in one leaf
+
+// ========================================
+
+/** Computes the surface area of the box (it is proportional to the probability of hit). */
+static float getArea(vec3 min, vec3 max)
+{
+	vec3 e = max - min;
+	return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+} // GET AREA
+
+// ========================================
+
+/** Finds the nearest intersection of the ray and the box (slab test). */
+static float intersectBox(vec3 origin, vec3 invDir, vec3 min, vec3 max, float tMax)
+{
+	vec3 t1 = (min - origin) * invDir;
+	vec3 t2 = (max - origin) * invDir;
+
+	float tNear = glm::max(glm::max(glm::min(t1.x, t2.x), glm::min(t1.y, t2.y)), glm::min(t1.z, t2.z));
+	float tFar = glm::min(glm::min(glm::max(t1.x, t2.x), glm::max(t1.y, t2.y)), glm::max(t1.z, t2.z));
+
+	return ((tNear <= tFar) && (tFar >= 0.0f) && (tNear < tMax)) ? glm::max(tNear, 0.0f) : INFINITY;
+} // INTERSECT BOX
+
+// ========================================
+
+/** Finds the intersection of the ray and the triangle (Moller-Trumbore). */
+static bool intersectTriangle(vec3 origin, vec3 dir, vec3 v0, vec3 v1, vec3 v2, float &t)
+{
+	vec3 e1 = v1 - v0;
+	vec3 e2 = v2 - v0;
+	vec3 p = cross(dir, e2);
+
+	float det = dot(e1, p);
+	if (abs(det) < 1e-8f) return false; // ray is parallel
+
+	float invDet = 1.0f / det;
+	vec3 s = origin - v0;
+
+	float u = dot(s, p) * invDet;
+	if ((u < 0.0f) || (u > 1.0f)) return false;
+
+	vec3 q = cross(s, e1);
+	float v = dot(dir, q) * invDet;
+	if ((v < 0.0f) || (u + v > 1.0f)) return false;
+
+	float hit = dot(e2, q) * invDet;
+	if ((hit < 0.0f) || (hit >= t)) return false;
+
+	t = hit;
+	return true;
+} // INTERSECT TRIANGLE
+
+// ========================================
+
+/** Checks whether the axis separates the triangle from the box (given by its center and half edges). */
+static bool isSeparated(vec3 axis, vec3 center, mat3 &axes, vec3 v0, vec3 v1, vec3 v2)
+{
+	if (dot(axis, axis) < 1e-12f) return false; // parallel edges give no axis
+
+	float c = dot(center, axis);
+	float r = abs(dot(axes[0], axis)) + abs(dot(axes[1], axis)) + abs(dot(axes[2], axis));
+
+	float p0 = dot(v0, axis), p1 = dot(v1, axis), p2 = dot(v2, axis);
+	return (glm::min(glm::min(p0, p1), p2) > c + r) || (glm::max(glm::max(p0, p1), p2) < c - r);
+} // IS SEPARATED
+
+// ========================================
+
+/** Separating axis test of the triangle and the box (it may be skewed by the transformation). */
+static bool overlapTriangle(vec3 center, mat3 &axes, vec3 v0, vec3 v1, vec3 v2)
+{
+	vec3 edges[3] = {v1 - v0, v2 - v1, v0 - v2};
+
+	// faces of the box and the triangle
+	if (isSeparated(cross(axes[1], axes[2]), center, axes, v0, v1, v2)) return false;
+	if (isSeparated(cross(axes[2], axes[0]), center, axes, v0, v1, v2)) return false;
+	if (isSeparated(cross(axes[0], axes[1]), center, axes, v0, v1, v2)) return false;
+	if (isSeparated(cross(edges[0], edges[1]), center, axes, v0, v1, v2)) return false;
+
+	// pairs of edges
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			if (isSeparated(cross(axes[i], edges[j]), center, axes, v0, v1, v2)) return false;
+
+	return true;
+} // OVERLAP TRIANGLE
+
+// ========================================
+
+const vector <vec3>    &Bvh::getTriangles() {return this->triangles;}
+const vector <BvhNode> &Bvh::getNodes()     {return this->nodes;}
+vec3                    Bvh::getMin()       {return this->nodes.empty() ? vec3(0.0f) : this->nodes[0].min;}
+vec3                    Bvh::getMax()       {return this->nodes.empty() ? vec3(0.0f) : this->nodes[0].max;}
+
+// ========================================
+
+bool Bvh::isEmpty()
+{
+	return this->nodes.empty();
+} // IS EMPTY
+
+// ========================================
+
+/** Copies indexed triangles, vertices start with position and have the stride given in floats. */
+void Bvh::addTriangles(const float *vertices, size_t stride, const unsigned int *indices, size_t count)
+{
+	for (size_t i = 0; i < 3 * count; i++)
+	{
+		const float *vertex = vertices + stride * indices[i];
+		this->triangles.push_back(vec3(vertex[0], vertex[1], vertex[2]));
+	} // for
+} // ADD TRIANGLES
+
+// ========================================
+
+/** Builds the hierarchy over all added triangles using surface area heuristic. */
+void Bvh::build()
+{
+	size_t count = this->triangles.size() / 3;
+	if (count == 0) return;
+
+	vector <vec3> centroids(count);
+	for (size_t i = 0; i < count; i++)
+		centroids[i] = (this->triangles[3 * i] + this->triangles[3 * i + 1] + this->triangles[3 * i + 2]) / 3.0f;
+
+	this->nodes.clear();
+	this->nodes.reserve(2 * count);
+	this->nodes.push_back({vec3(0.0f), 0, vec3(0.0f), (unsigned int)count});
+
+	this->subdivide(0, centroids);
+} // BUILD
+
+// ========================================
+
+void Bvh::subdivide(unsigned int node, vector <vec3> &centroids)
+{
+	unsigned int first = this->nodes[node].first;
+	unsigned int count = this->nodes[node].count;
+
+	// bounds of triangles and of their centroids
+	vec3 min = vec3(INFINITY), max = vec3(-INFINITY);
+	vec3 cMin = vec3(INFINITY), cMax = vec3(-INFINITY);
+	for (unsigned int i = first; i < first + count; i++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			min = glm::min(min, this->triangles[3 * i + j]);
+			max = glm::max(max, this->triangles[3 * i + j]);
+		} // for
+
+		cMin = glm::min(cMin, centroids[i]);
+		cMax = glm::max(cMax, centroids[i]);
+	} // for
+
+	this->nodes[node].min = min;
+	this->nodes[node].max = max;
+
+	if (count <= LEAF_SIZE) return;
+
+	// ****************************************
+
+	// find the cheapest split among bins of all axes
+	int bestAxis = -1, bestSplit = 0;
+	float bestCost = (float)count * getArea(min, max); // cost of leaf
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float extent = cMax[axis] - cMin[axis];
+		if (extent <= 0.0f) continue;
+
+		vec3 binMin[BINS], binMax[BINS];
+		int binCount[BINS] = {0};
+		for (int b = 0; b < BINS; b++)
+		{
+			binMin[b] = vec3(INFINITY);
+			binMax[b] = vec3(-INFINITY);
+		} // for
+
+		for (unsigned int i = first; i < first + count; i++)
+		{
+			int b = std::min((int)(BINS * (centroids[i][axis] - cMin[axis]) / extent), BINS - 1);
+			binCount[b]++;
+			for (int j = 0; j < 3; j++)
+			{
+				binMin[b] = glm::min(binMin[b], this->triangles[3 * i + j]);
+				binMax[b] = glm::max(binMax[b], this->triangles[3 * i + j]);
+			} // for
+		} // for
+
+		// sweep from the right to get areas of all right parts
+		float rightArea[BINS];
+		int rightCount[BINS];
+		vec3 rMin = vec3(INFINITY), rMax = vec3(-INFINITY);
+		int rCount = 0;
+		for (int b = BINS - 1; b > 0; b--)
+		{
+			rCount += binCount[b];
+			if (binCount[b] > 0)
+			{
+				rMin = glm::min(rMin, binMin[b]);
+				rMax = glm::max(rMax, binMax[b]);
+			} // if
+
+			rightCount[b] = rCount;
+			rightArea[b] = rCount ? getArea(rMin, rMax) : 0.0f;
+		} // for
+
+		// sweep from the left and evaluate each split
+		vec3 lMin = vec3(INFINITY), lMax = vec3(-INFINITY);
+		int lCount = 0;
+		for (int b = 0; b < BINS - 1; b++)
+		{
+			lCount += binCount[b];
+			if (binCount[b] > 0)
+			{
+				lMin = glm::min(lMin, binMin[b]);
+				lMax = glm::max(lMax, binMax[b]);
+			} // if
+
+			if ((lCount == 0) || (rightCount[b + 1] == 0)) continue;
+
+			float cost = lCount * getArea(lMin, lMax) + rightCount[b + 1] * rightArea[b + 1];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = b;
+			} // if
+		} // for
+	} // for
+
+	if (bestAxis < 0) return; // leaf is cheaper
+
+	// ****************************************
+
+	// partition triangles by the chosen bin
+	float extent = cMax[bestAxis] - cMin[bestAxis];
+	unsigned int i = first, j = first + count - 1;
+	while (i <= j)
+	{
+		int b = std::min((int)(BINS * (centroids[i][bestAxis] - cMin[bestAxis]) / extent), BINS - 1);
+		if (b <= bestSplit)
+			i++;
+		else
+		{
+			std::swap(centroids[i], centroids[j]);
+			for (int k = 0; k < 3; k++)
+				std::swap(this->triangles[3 * i + k], this->triangles[3 * j + k]);
+			j--;
+		} // else
+	} // while
+
+	unsigned int leftCount = i - first;
+	if ((leftCount == 0) || (leftCount == count)) return;
+
+	// create both children next to each other
+	unsigned int left = (unsigned int)this->nodes.size();
+	this->nodes.push_back({vec3(0.0f), first, vec3(0.0f), leftCount});
+	this->nodes.push_back({vec3(0.0f), i, vec3(0.0f), count - leftCount});
+
+	this->nodes[node].first = left;
+	this->nodes[node].count = 0;
+
+	this->subdivide(left, centroids);
+	this->subdivide(left + 1, centroids);
+} // SUBDIVIDE
+
+// ========================================
+
+/** Finds the nearest hit of the ray (origin + t * dir), t must be set to the maximal distance. */
+bool Bvh::intersectRay(vec3 origin, vec3 dir, float &t)
+{
+	if (this->nodes.empty()) return false;
+
+	vec3 invDir = vec3(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z);
+	bool hit = false;
+
+	unsigned int stack[64];
+	int size = 0;
+	stack[size++] = 0;
+
+	while (size > 0)
+	{
+		const BvhNode &node = this->nodes[stack[--size]];
+		if (intersectBox(origin, invDir, node.min, node.max, t) == INFINITY) continue;
+
+		if (node.count > 0) // leaf
+		{
+			for (unsigned int i = node.first; i < node.first + node.count; i++)
+				hit |= intersectTriangle(origin, dir, this->triangles[3 * i], this->triangles[3 * i + 1], this->triangles[3 * i + 2], t);
+		} // if
+		else // visit the nearer child first
+		{
+			const BvhNode &left = this->nodes[node.first];
+			const BvhNode &right = this->nodes[node.first + 1];
+
+			float tLeft = intersectBox(origin, invDir, left.min, left.max, t);
+			float tRight = intersectBox(origin, invDir, right.min, right.max, t);
+
+			if (tLeft <= tRight)
+			{
+				if (tRight != INFINITY) stack[size++] = node.first + 1;
+				if (tLeft != INFINITY) stack[size++] = node.first;
+			} // if
+			else
+			{
+				if (tLeft != INFINITY) stack[size++] = node.first;
+				if (tRight != INFINITY) stack[size++] = node.first + 1;
+			} // else
+		} // else
+	} // while
+
+	return hit;
+} // INTERSECT RAY
+
+// ========================================
+
+/** Checks whether any triangle touches the box, axes hold its half edges (model space). */
+bool Bvh::overlapBox(vec3 center, mat3 axes)
+{
+	if (this->nodes.empty()) return false;
+
+	// bounding box of the box
+	vec3 extent = abs(axes[0]) + abs(axes[1]) + abs(axes[2]);
+	vec3 min = center - extent, max = center + extent;
+
+	unsigned int stack[64];
+	int size = 0;
+	stack[size++] = 0;
+
+	while (size > 0)
+	{
+		const BvhNode &node = this->nodes[stack[--size]];
+
+		if ((node.min.x > max.x) || (node.max.x < min.x) ||
+			  (node.min.y > max.y) || (node.max.y < min.y) ||
+			  (node.min.z > max.z) || (node.max.z < min.z))
+			continue;
+
+		if (node.count > 0) // leaf
+		{
+			for (unsigned int i = node.first; i < node.first + node.count; i++)
+				if (overlapTriangle(center, axes, this->triangles[3 * i], this->triangles[3 * i + 1], this->triangles[3 * i + 2]))
+					return true;
+		} // if
+		else
+		{
+			stack[size++] = node.first;
+			stack[size++] = node.first + 1;
+		} // else
+	} // while
+
+	return false;
+} // OVERLAP BOX
@@ -0,0 +1,73 @@
+#include "pgr.h"
+#include "headers/cache.h"
+
+// ========================================
+
+StaticCache::StaticCache(int width, int height)
+{
+	this->target = new RenderTarget(width, height);
+	this->valid = false;
+	this->view = 0;
+	this->scale = 0.0f;
+} // CONSTRUCTOR
+
+// ========================================
+
+StaticCache::~StaticCache()
+{
+	delete this->target;
+} // DESTRUCTOR
+
+// ========================================
+
+RenderTarget *StaticCache::getTarget() {return this->target;}
+
+// ========================================
+
+/** Checks whether the cached picture belongs to the view rendered with the same scale. */
+bool StaticCache::isValid(int view, float scale)
+{
+	return this->valid && (this->view == view) && (this->scale == scale);
+} // IS VALID
+
+// ========================================
+
+/** Forgets the cached picture (e.g. lighting has changed). */
+void StaticCache::invalidate()
+{
+	this->valid = false;
+} // INVALIDATE
+
+// ========================================
+
+void StaticCache::resize(int width, int height)
+{
+	this->target->resize(width, height);
+	this->valid = false;
+} // RESIZE
+
+// ========================================
+
+/** Copies the static scene (including object ids) into the cache. */
+void StaticCache::store(RenderTarget *from, int width, int height, int view, float scale)
+{
+	from->copy(this->target, width, height);
+
+	// continue rendering into the original target
+	glBindFramebuffer(GL_FRAMEBUFFER, from->getFbo());
+
+	this->valid = true;
+	this->view = view;
+	this->scale = scale;
+} // STORE
+
+// ========================================
+
+/** Copies the static scene (including object ids) from the cache. */
+void StaticCache::restore(RenderTarget *to, int width, int height)
+{
+	this->target->copy(to, width, height);
+
+	// continue rendering into the original target
+	glBindFramebuffer(GL_FRAMEBUFFER, to->getFbo());
+} // RESTORE
@@ -2,7 +2,6 @@
 
 #include "headers/camera.h"
 #include "headers/data.h"
-#include "headers/spline.h"
 #include "headers/helpers.h"
 
 extern bool planeModeOn;
@@ -12,11 +11,9 @@ extern bool freeCamOn;
 
 Camera::Camera(vec3 pos, vec3 dir, vec3 up)
 {
-	this->plane = nullptr;
-
-	this->pos = this->defPos = pos;
-	this->dir = this->defDir = dir;
-	this->up = this->defUp = up;
+	this->pos = this->defPos = this->prevPos = pos;
+	this->dir = this->defDir = this->prevDir = dir;
+	this->up = this->defUp = this->prevUp = up;
 
 	this->vMatrix = lookAt(pos, pos + dir, up);
 
@@ -28,8 +25,8 @@ Camera::Camera(vec3 pos, vec3 dir, vec3 up)
 
 // ========================================
 
-Object** Camera::getPlane()                                 {return this->plane;}
-void     Camera::setPlane(Object** plane)                   {this->plane = plane;}
+Object*  Camera::getPlane()                                 {return entities->getOwner(this->plane);}
+void     Camera::setPlane(Object* plane)                    {this->plane = plane ? plane->getHandle() : EntityHandle();}
 
 vec3     Camera::getPos()                                   {return this->pos;}
 void     Camera::setPos(vec3 pos)                           {this->pos = pos;}
@@ -66,31 +63,59 @@ void     Camera::setStartTime(float startTime)              {this->startTime = s
 
 // ========================================
 
+/** Blends the view of the last two simulation steps. */
+mat4 Camera::getVMatrix(float alpha)
+{
+	vec3 pos = mix(this->prevPos, this->pos, alpha);
+	vec3 dir = mix(this->prevDir, this->dir, alpha);
+	vec3 up = mix(this->prevUp, this->up, alpha);
+
+	if ((length(dir) < 1e-4f) || (length(up) < 1e-4f)) // camera has turned around (e.g. switched)
+		return lookAt(this->pos, this->pos + this->dir, this->up);
+
+	return lookAt(pos, pos + normalize(dir), normalize(up));
+} // GET V MATRIX
+
+// ========================================
+
+/** Remembers the state before the next simulation step. */
+void Camera::saveState()
+{
+	this->prevPos = this->pos;
+	this->prevDir = this->dir;
+	this->prevUp = this->up;
+} // SAVE STATE
+
+// ========================================
+
 /** Controls the transfer from the ground onto the plane. */
-bool Camera::interactWithPlane(Object** jetPlane, Object** fighterPlane, Object** retroPlane)
+bool Camera::interactWithPlane(Object* jetPlane, Object* fighterPlane, Object* retroPlane)
 {
+	Object *plane = this->getPlane();
+
 	// get off only when the plane is on the ground with no speed
-	if (planeModeOn && ((*this->plane)->getCurrSpeed() == 0.0f) && ((*this->plane)->getPos().y == (*this->plane)->getDefPos().y))
+	if (planeModeOn && plane && (plane->getCurrSpeed() == 0.0f) && (plane->getPos().y <= getGroundLevel(plane)))
 	{
-		this->setPos((*this->plane)->getPos() - 4.0f * normalize((*this->plane)->getDir()));
-		this->plane = nullptr;
+		this->setPos(plane->getPos() - 4.0f * normalize(plane->getDir()));
+		this->setPlane(nullptr);
 
 		return false;
 	} // if
 
 	// get on only when the player is near the plane
-	if (*jetPlane && (*jetPlane)->isPlayerNearby(this->pos))
-		this->plane = jetPlane;
-	else if (*fighterPlane && (*fighterPlane)->isPlayerNearby(this->pos))
-		this->plane = fighterPlane;
-	else if (*retroPlane && (*retroPlane)->isPlayerNearby(this->pos))
-		this->plane = retroPlane;
+	if (jetPlane && jetPlane->isPlayerNearby(this->pos))
+		this->setPlane(jetPlane);
+	else if (fighterPlane && fighterPlane->isPlayerNearby(this->pos))
+		this->setPlane(fighterPlane);
+	else if (retroPlane && retroPlane->isPlayerNearby(this->pos))
+		this->setPlane(retroPlane);
 
 	// player is near the plane
-	if (this->plane)
+	plane = this->getPlane();
+	if (plane)
 	{
-		vec3 planePos = (*this->plane)->getPos();
-		vec3 planeDir = normalize((*this->plane)->getDir());
+		vec3 planePos = plane->getPos();
+		vec3 planeDir = normalize(plane->getDir());
 
 		this->pos = planePos - 4.0f * planeDir + vec3(0.0f, 2.0f, 0.0f);
 		this->angleX = degrees(acos(dot(this->defDir, planeDir) / (length(this->defDir) * length(planeDir))));
@@ -151,15 +176,20 @@ void Camera::updatePosWhileWalking(State* state)
 	this->pos += this->speed * moveDir; // update the camera position
 
 	if (!freeCamOn) // real camera
+	{
 		if (checkCollisions(this->pos, vec3(0.0f)) || checkBounds(nullptr))
 			this->pos = oldPos;
+		else
+			this->pos.y = heightfield->getHeight(this->pos.x, this->pos.z) + EYE_HEIGHT; // walk on the ground
+	} // if
 } // UPDATE POS WHILE WALKING
 
 // ========================================
 
 void Camera::updatePosWhileFlying(State* state)
 {
-	if (state->isGameOver()) return; // not working when game is over
+	Object *plane = this->getPlane();
+	if (state->isGameOver() || !plane) return; // not working when game is over
 
 	// ****************************************
 
@@ -178,64 +208,73 @@ void Camera::updatePosWhileFlying(State* state)
 	// ****************************************
 
 	if (state->isPressed(KEY_W)) // speed up
-		(*this->plane)->setCurrSpeed(std::min((*this->plane)->getCurrSpeed() + (*this->plane)->getAccel(), (*this->plane)->getMaxSpeed()));
+		plane->setCurrSpeed(std::min(plane->getCurrSpeed() + plane->getAccel(), plane->getMaxSpeed()));
 
 	if (state->isPressed(KEY_S)) // slow down
-		(*this->plane)->setCurrSpeed(std::max((*this->plane)->getCurrSpeed() - (*this->plane)->getAccel(), 0.0f));
+		plane->setCurrSpeed(std::max(plane->getCurrSpeed() - plane->getAccel(), 0.0f));
 
 	// ****************************************
 
 	if (state->isPressed(KEY_A)) // to the left
 	{
-		vec3 plnAngle = (*this->plane)->getAngle();
+		vec3 plnAngle = plane->getAngle();
 
 		plnAngle.y += ANGLE_INC;
 		if (plnAngle.y >= 360.0f)
 			plnAngle.y = 0.0f;
 
-		(*this->plane)->setDir(normalize(vec3(sin(radians(plnAngle.y)), 0.0f, cos(radians(plnAngle.y)))));
-		(*this->plane)->setAngle(plnAngle);
+		plane->setDir(normalize(vec3(sin(radians(plnAngle.y)), 0.0f, cos(radians(plnAngle.y)))));
+		plane->setAngle(plnAngle);
 	} // if
 
 	if (state->isPressed(KEY_D)) // to the right
 	{
-		vec3 plnAngle = (*this->plane)->getAngle();
+		vec3 plnAngle = plane->getAngle();
 
 		plnAngle.y -= ANGLE_INC;
 		if (plnAngle.y <= 0.0f)
 			plnAngle.y = 360.0f;
 
-		(*this->plane)->setDir(normalize(vec3(sin(radians(plnAngle.y)), 0.0f, cos(radians(plnAngle.y)))));
-		(*this->plane)->setAngle(plnAngle);
+		plane->setDir(normalize(vec3(sin(radians(plnAngle.y)), 0.0f, cos(radians(plnAngle.y)))));
+		plane->setAngle(plnAngle);
 	} // if
 
 	// ****************************************
 
-	if ((*this->plane)->getCurrSpeed() >= TAKE_OFF_SPEED) // enough speed to take off
+	if (plane->getCurrSpeed() >= TAKE_OFF_SPEED) // enough speed to take off
 	{
 		if (state->isPressed(KEY_E)) // up
-			(*this->plane)->setPos((*this->plane)->getPos() + vec3(0.0f, 0.05f, 0.0f));
+			plane->setPos(plane->getPos() + vec3(0.0f, 0.05f, 0.0f));
 
 		if (state->isPressed(KEY_Q)) // down
-			(*this->plane)->setPos((*this->plane)->getPos() - vec3(0.0f, 0.05f, 0.0f));
+			plane->setPos(plane->getPos() - vec3(0.0f, 0.05f, 0.0f));
 	} // if
 	else // low speed to land
-		(*this->plane)->setPos((*this->plane)->getPos() - vec3(0.0f, 0.07f, 0.0f));
+		plane->setPos(plane->getPos() - vec3(0.0f, 0.07f, 0.0f));
 
 	// ****************************************
 
-	vec3 oldPos = (*this->plane)->getPos(); // save old position
+	vec3 oldPos = plane->getPos(); // save old position
+	vec3 newPos = oldPos + plane->getCurrSpeed() * normalize(plane->getDir());
 
-	(*this->plane)->setPos((*this->plane)->getPos() + (*this->plane)->getCurrSpeed() * normalize((*this->plane)->getDir())); // update plane position
-	this->pos = (*this->plane)->getPos() - 4.0f * normalize((*this->plane)->getDir()) + vec3(0.0f, 2.0f, 0.0f); // update camera position
+	// stop at the first contact along the way, so fast planes do not fly through thin objects
+	float toi = sweepCollisions(plane, oldPos, newPos);
+
+	plane->setPos(oldPos + toi * (newPos - oldPos)); // update plane position
+	this->pos = plane->getPos() - 4.0f * normalize(plane->getDir()) + vec3(0.0f, 2.0f, 0.0f); // update camera position
 	
-	if (checkCollisions((*this->plane)->getPos(), (*this->plane)->getBoundBox()))
+	if (checkCollisions(plane->getPos(), plane->getBoundBox()))
 	{
-		(*this->plane)->setPos(oldPos);
-		(*this->plane)->setCurrSpeed(0.0f);
+		plane->setPos(oldPos);
+		plane->setCurrSpeed(0.0f);
 	} // if
 
-	checkBounds(this->plane);
+	plane = this->getPlane(); // nothing when it has crashed into another object
+	if (plane && checkTerrain(plane, oldPos, plane->getPos()))
+		return; // crashed into a slope
+
+	if (plane && !checkBounds(plane)) // plane has not crashed
+		grid->update(plane);
 } // UPDATE POS WHILE FLYING
 
 // ========================================
@@ -257,12 +296,12 @@ void Camera::updateAngle()
 // ========================================
 
 /** Updates moving camera on the curve. */
-void Camera::update(State* state, const vec3* curveData, size_t curveSize)
+void Camera::update(State* state, SplinePath* path)
 {
-	float time = 0.3f * (state->getElapsedTime() - this->startTime);
+	float distance = EXHIBITION_SPEED * (state->getElapsedTime() - this->startTime);
 
-	this->setPos(evaluateClosedCurve(curveData, curveSize, time));
-	this->setDir(normalize(evaluateClosedCurve_1stDerivative(curveData, curveSize, time)));
+	this->setPos(path->getPos(distance));
+	this->setDir(path->getTangent(distance));
 	this->setUp(Y_AXIS);
 
 	this->setVMatrix(this->pos, this->pos + this->dir, this->up); // set the new view
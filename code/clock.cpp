@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "headers/clock.h"
+#include "headers/helpers.h"
+
+// ========================================
+
+WallClock::WallClock(double warp)
+{
+	this->start = getWallTime();
+	this->warp = std::max(warp, 0.001);
+} // CONSTRUCTOR
+
+// ========================================
+
+double WallClock::getTime()
+{
+	return this->start + (getWallTime() - this->start) * this->warp;
+} // GET TIME
+
+// ========================================
+
+void WallClock::wait(double duration)
+{
+	if (duration > 0.0)
+		this_thread::sleep_for(chrono::duration<double>(duration / this->warp));
+} // WAIT
+
+// ========================================
+
+ManualClock::ManualClock()
+{
+	this->time = 0.0;
+} // CONSTRUCTOR
+
+// ========================================
+
+double ManualClock::getTime() {return this->time;}
+
+// ========================================
+
+/** Nothing to wait for, the time just jumps. */
+void ManualClock::wait(double duration)
+{
+	this->time += std::max(duration, 0.0);
+} // WAIT
+
+// ========================================
+
+StepTimer::StepTimer()
+{
+	this->total = 0.0;
+} // CONSTRUCTOR
+
+// ========================================
+
+size_t StepTimer::getCount() {return this->durations.size();}
+double StepTimer::getTotal() {return this->total;}
+
+// ========================================
+
+double StepTimer::getMean()
+{
+	return this->durations.empty() ? 0.0 : this->total / this->durations.size();
+} // GET MEAN
+
+// ========================================
+
+double StepTimer::getMax()
+{
+	return this->durations.empty() ? 0.0 : *max_element(this->durations.begin(), this->durations.end());
+} // GET MAX
+
+// ========================================
+
+/** Returns the duration not exceeded by the given percentage of steps (e.g. 95). */
+double StepTimer::getPercentile(double percent)
+{
+	if (this->durations.empty()) return 0.0;
+
+	vector <double> sorted = this->durations;
+	size_t k = std::min((size_t)(percent / 100.0 * sorted.size()), sorted.size() - 1);
+	nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+
+	return sorted[k];
+} // GET PERCENTILE
+
+// ========================================
+
+void StepTimer::add(double duration)
+{
+	this->durations.push_back(duration);
+	this->total += duration;
+} // ADD
@@ -0,0 +1,93 @@
+#include "pgr.h"
+#include "headers/culler.h"
+#include "headers/data.h"
+#include "headers/hud.h"
+
+// ========================================
+
+Culler::Culler(GLuint program)
+{
+	this->program = program;
+
+	this->box = new Mesh();
+	this->box->createBoundBoxMesh(program);
+} // CONSTRUCTOR
+
+// ========================================
+
+Culler::~Culler()
+{
+	for (auto it : this->queries)
+		glDeleteQueries(1, &it.second);
+
+	delete this->box;
+} // DESTRUCTOR
+
+// ========================================
+
+GLuint Culler::getProgram()               {return this->program;}
+void   Culler::setProgram(GLuint program) {this->program = program;}
+
+// ========================================
+
+/** Checks whether the object was visible in the last finished query. */
+bool Culler::isVisible(int id)
+{
+	auto it = this->visible.find(id);
+	return (it == this->visible.end()) || it->second; // unknown objects are visible
+} // IS VISIBLE
+
+// ========================================
+
+/** Draws the bounding box of the object against the depth buffer, the result is used in one of next frames. */
+void Culler::query(int id, vec3 pos, vec3 extent, vec3 eye, mat4 pMatrix, mat4 vMatrix)
+{
+	// camera inside the box would clip the box by the near plane
+	if ((abs(eye.x - pos.x) <= extent.x) && (abs(eye.y - pos.y) <= extent.y) && (abs(eye.z - pos.z) <= extent.z))
+	{
+		this->visible[id] = true;
+		return;
+	} // if
+
+	// ****************************************
+
+	GLuint &query = this->queries[id];
+	if (query == 0) // first query of the object
+		glGenQueries(1, &query);
+	else
+	{
+		GLuint available = 0;
+		glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) return; // do not wait for GPU, keep the old result
+
+		GLuint samples = 0;
+		glGetQueryObjectuiv(query, GL_QUERY_RESULT, &samples);
+		this->visible[id] = (samples > 0);
+	} // else
+
+	// ****************************************
+
+	mat4 mMatrix = scale(translate(mat4(1.0f), pos), extent);
+
+	glUseProgram(this->program);
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE); // do not change the picture
+	glDepthMask(GL_FALSE); // do not change the depth
+
+	// send data to vertex shader
+	glUniformMatrix4fv(glGetUniformLocation(this->program, P_MAT_VAR), 1, GL_FALSE, value_ptr(pMatrix));
+	glUniformMatrix4fv(glGetUniformLocation(this->program, V_MAT_VAR), 1, GL_FALSE, value_ptr(vMatrix));
+	glUniformMatrix4fv(glGetUniformLocation(this->program, M_MAT_VAR), 1, GL_FALSE, value_ptr(mMatrix));
+	renderStats.addProgram(3);
+
+	// draw vertices
+	glBeginQuery(GL_ANY_SAMPLES_PASSED, query);
+	glBindVertexArray(this->box->getVao());
+	glDrawArrays(GL_TRIANGLES, 0, 36);
+	glBindVertexArray(0);
+	renderStats.addDraw(GL_TRIANGLES, 36);
+	glEndQuery(GL_ANY_SAMPLES_PASSED);
+
+	glDepthMask(GL_TRUE);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glUseProgram(0);
+} // QUERY
@@ -0,0 +1,258 @@
+#include "headers/entities.h"
+#include "headers/simd.h"
+
+// ========================================
+
+/** Inverse transpose of the rotation and scale part, columns of such matrix only need to be divided by their squared lengths. */
+mat4 getNormalMatrix(const mat4 &mMatrix)
+{
+	mat4 nMatrix = mat4(1.0f);
+
+	for (int i = 0; i < 3; i++)
+	{
+		vec3 column = vec3(mMatrix[i]);
+		float length2 = dot(column, column);
+		nMatrix[i] = vec4((length2 > 0.0f) ? column / length2 : vec3(0.0f), 0.0f);
+	} // for
+
+	return nMatrix;
+} // GET NORMAL MATRIX
+
+// ========================================
+
+EntityStore::EntityStore(size_t capacity)
+{
+	this->capacity = capacity;
+	this->highWater = 0;
+	this->frozen = 0;
+
+	// all memory is taken at once, so nothing is moved by later allocations
+	this->generations.resize(capacity, 0);
+	this->owners.resize(capacity, nullptr);
+	this->freeSlots.reserve(capacity);
+
+	for (auto it : {&this->pos, &this->prevPos, &this->dir, &this->prevDir, &this->angle, &this->prevAngle, &this->size, &this->boundBox})
+		it->resize(capacity, vec3(0.0f));
+
+	for (auto it : {&this->currSpeed, &this->maxSpeed, &this->accel})
+		it->resize(capacity, 0.0f);
+
+	this->world.resize(capacity, mat4(1.0f));
+	this->normal.resize(capacity, mat4(1.0f));
+	this->dirty.resize(capacity, 1);
+	this->custom.resize(capacity, 0);
+	this->batch.reserve(capacity);
+} // CONSTRUCTOR
+
+// ========================================
+
+size_t EntityStore::getCapacity()  {return this->capacity;}
+size_t EntityStore::getHighWater() {return this->highWater;}
+size_t EntityStore::getFrozen()    {return this->frozen;}
+size_t EntityStore::getCount()     {return this->highWater - this->freeSlots.size();}
+
+// ========================================
+
+/** Takes a free slot (recycled ones first) and fills it. */
+EntityHandle EntityStore::create(Object *owner, vec3 pos, vec3 dir, vec3 size, vec3 boundBox, vec3 angle, float currSpeed, float maxSpeed, float accel)
+{
+	unsigned int index;
+	if (!this->freeSlots.empty())
+	{
+		index = this->freeSlots.back();
+		this->freeSlots.pop_back();
+	} // if
+	else if (this->highWater < this->capacity)
+		index = (unsigned int)this->highWater++;
+	else
+		pgr::dieWithError("ENTITY STORE IS FULL");
+
+	// ****************************************
+
+	this->generations[index]++; // odd generations are alive
+	this->owners[index] = owner;
+
+	this->pos[index] = this->prevPos[index] = pos;
+	this->dir[index] = this->prevDir[index] = dir;
+	this->angle[index] = this->prevAngle[index] = angle;
+	this->size[index] = size;
+	this->boundBox[index] = boundBox;
+	this->currSpeed[index] = currSpeed;
+	this->maxSpeed[index] = maxSpeed;
+	this->accel[index] = accel;
+
+	this->dirty[index] = 1;
+	this->custom[index] = 0;
+
+	return EntityHandle(index, this->generations[index]);
+} // CREATE
+
+// ========================================
+
+void EntityStore::destroy(EntityHandle handle)
+{
+	if (!this->isAlive(handle) || (handle.index < this->frozen)) return;
+
+	this->generations[handle.index]++; // all handles to the slot become stale
+	this->owners[handle.index] = nullptr;
+	this->freeSlots.push_back(handle.index);
+} // DESTROY
+
+// ========================================
+
+bool EntityStore::isAlive(EntityHandle handle)
+{
+	return (handle.index < this->highWater) && (handle.generation & 1) && (this->generations[handle.index] == handle.generation);
+} // IS ALIVE
+
+// ========================================
+
+/** Returns the object of the entity or nullptr when it has been destroyed. */
+Object* EntityStore::getOwner(EntityHandle handle)
+{
+	return this->isAlive(handle) ? this->owners[handle.index] : nullptr;
+} // GET OWNER
+
+// ========================================
+
+/** Marks everything created so far as never changing, other threads may read it without copying. */
+void EntityStore::freeze()
+{
+	this->updateMatrices(); // scenery matrices are never built again
+	this->frozen = this->highWater;
+} // FREEZE
+
+// ========================================
+
+void EntityStore::saveStates(size_t begin, size_t end)
+{
+	copy(this->pos.begin() + begin, this->pos.begin() + end, this->prevPos.begin() + begin);
+	copy(this->dir.begin() + begin, this->dir.begin() + end, this->prevDir.begin() + begin);
+	copy(this->angle.begin() + begin, this->angle.begin() + end, this->prevAngle.begin() + begin);
+} // SAVE STATES
+
+// ========================================
+
+/** Remembers the state before the next simulation step for all moving entities, chunks go to the workers when there are any. */
+void EntityStore::saveStates(JobSystem *jobs)
+{
+	size_t first = this->frozen, count = this->highWater - this->frozen;
+
+	if (jobs)
+		jobs->parallelFor(count, COPY_GRAIN, [this, first](size_t begin, size_t end) {this->saveStates(first + begin, first + end);});
+	else
+		this->saveStates(first, first + count);
+} // SAVE STATES
+
+// ========================================
+
+/** Copies the moving part of another store (e.g. into a snapshot for the renderer), objects are not copied. */
+void EntityStore::copyFrom(EntityStore &other)
+{
+	size_t first = other.frozen, count = std::min(other.highWater, this->capacity);
+	this->highWater = count;
+	this->frozen = first;
+
+	copy(other.generations.begin(), other.generations.begin() + count, this->generations.begin());
+
+	copy(other.pos.begin() + first, other.pos.begin() + count, this->pos.begin() + first);
+	copy(other.prevPos.begin() + first, other.prevPos.begin() + count, this->prevPos.begin() + first);
+	copy(other.dir.begin() + first, other.dir.begin() + count, this->dir.begin() + first);
+	copy(other.prevDir.begin() + first, other.prevDir.begin() + count, this->prevDir.begin() + first);
+	copy(other.angle.begin() + first, other.angle.begin() + count, this->angle.begin() + first);
+	copy(other.prevAngle.begin() + first, other.prevAngle.begin() + count, this->prevAngle.begin() + first);
+	copy(other.size.begin() + first, other.size.begin() + count, this->size.begin() + first);
+	copy(other.boundBox.begin() + first, other.boundBox.begin() + count, this->boundBox.begin() + first);
+	copy(other.currSpeed.begin() + first, other.currSpeed.begin() + count, this->currSpeed.begin() + first);
+	copy(other.maxSpeed.begin() + first, other.maxSpeed.begin() + count, this->maxSpeed.begin() + first);
+	copy(other.accel.begin() + first, other.accel.begin() + count, this->accel.begin() + first);
+	copy(other.world.begin() + first, other.world.begin() + count, this->world.begin() + first);
+	copy(other.normal.begin() + first, other.normal.begin() + count, this->normal.begin() + first);
+	copy(other.dirty.begin() + first, other.dirty.begin() + count, this->dirty.begin() + first);
+	copy(other.custom.begin() + first, other.custom.begin() + count, this->custom.begin() + first);
+} // COPY FROM
+
+// ========================================
+
+/** Rebuilds matrices of all dirty entities in batches of four, chunks of batches go to the workers when there are any. */
+void EntityStore::updateMatrices(JobSystem *jobs)
+{
+	this->batch.clear();
+
+	for (size_t i = this->frozen; i < this->highWater; i++)
+		if (this->dirty[i] && !this->custom[i] && (this->generations[i] & 1))
+			this->batch.push_back((unsigned int)i);
+
+	// every entity is written by one chunk only, chunks start at multiples of four
+	auto build = [this](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i += 4)
+			this->buildMatrices(&this->batch[i], std::min(end - i, (size_t)4));
+	};
+
+	if (jobs)
+		jobs->parallelFor(this->batch.size(), MATRIX_GRAIN, build);
+	else
+		build(0, this->batch.size());
+} // UPDATE MATRICES
+
+// ========================================
+
+/** Builds translate * rotateZ * rotateY * rotateX * scale of up to four entities in closed form. */
+void EntityStore::buildMatrices(const unsigned int *indices, size_t count)
+{
+	alignas(16) float in[9][4]; // cos and sin of the angles, scale
+	alignas(16) float out[18][4]; // 9 terms of the world matrix, 9 terms of the normal matrix
+
+	for (size_t lane = 0; lane < 4; lane++)
+	{
+		unsigned int i = indices[std::min(lane, count - 1)]; // missing lanes repeat the last entity
+		float ax = radians(this->angle[i].x), ay = radians(this->angle[i].y), az = radians(this->angle[i].z);
+
+		in[0][lane] = cos(ax); in[1][lane] = sin(ax);
+		in[2][lane] = cos(ay); in[3][lane] = sin(ay);
+		in[4][lane] = cos(az); in[5][lane] = sin(az);
+		in[6][lane] = this->size[i].x; in[7][lane] = this->size[i].y; in[8][lane] = this->size[i].z;
+	} // for
+
+	// ****************************************
+
+	Float4 cx(in[0]), sx(in[1]), cy(in[2]), sy(in[3]), cz(in[4]), sz(in[5]);
+	Float4 scale[3] = {Float4(in[6]), Float4(in[7]), Float4(in[8])};
+
+	// columns of the rotation
+	Float4 rotation[3][3] =
+	{
+		{cz * cy, sz * cy, -sy},
+		{cz * sy * sx - sz * cx, sz * sy * sx + cz * cx, cy * sx},
+		{cz * sy * cx + sz * sx, sz * sy * cx - cz * sx, cy * cx}
+	};
+
+	for (int c = 0; c < 3; c++)
+	{
+		Float4 invScale = safeRcp(scale[c]);
+
+		for (int r = 0; r < 3; r++)
+		{
+			(rotation[c][r] * scale[c]).store(out[3 * c + r]);
+			(rotation[c][r] * invScale).store(out[9 + 3 * c + r]);
+		} // for
+	} // for
+
+	// ****************************************
+
+	for (size_t lane = 0; lane < count; lane++)
+	{
+		unsigned int i = indices[lane];
+
+		for (int c = 0; c < 3; c++)
+		{
+			this->world[i][c] = vec4(out[3 * c][lane], out[3 * c + 1][lane], out[3 * c + 2][lane], 0.0f);
+			this->normal[i][c] = vec4(out[9 + 3 * c][lane], out[9 + 3 * c + 1][lane], out[9 + 3 * c + 2][lane], 0.0f);
+		} // for
+
+		this->world[i][3] = vec4(this->pos[i].x, this->pos[i].y, this->pos[i].z, 1.0f);
+		this->normal[i][3] = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		this->dirty[i] = 0;
+	} // for
+} // BUILD MATRICES
@@ -0,0 +1,136 @@
+#include <algorithm>
+
+#include "headers/grid.h"
+
+// ========================================
+
+SpatialGrid::SpatialGrid(float width, float depth, float cellSize)
+{
+	this->origin = vec2(-width, -depth);
+	this->cellSize = cellSize;
+
+	this->cols = (int)ceil(2.0f * width / cellSize);
+	this->rows = (int)ceil(2.0f * depth / cellSize);
+
+	this->cells.resize(this->cols * this->rows);
+} // CONSTRUCTOR
+
+// ========================================
+
+float  SpatialGrid::getCellSize() {return this->cellSize;}
+int    SpatialGrid::getCols()     {return this->cols;}
+int    SpatialGrid::getRows()     {return this->rows;}
+size_t SpatialGrid::getCount()    {return this->ranges.size();}
+
+// ========================================
+
+/** Converts the box into cells, anything outside the grid falls into the border cells. */
+CellRange SpatialGrid::getRange(vec3 min, vec3 max)
+{
+	CellRange range;
+	range.x0 = clamp((int)floor((min.x - this->origin.x) / this->cellSize), 0, this->cols - 1);
+	range.z0 = clamp((int)floor((min.z - this->origin.y) / this->cellSize), 0, this->rows - 1);
+	range.x1 = clamp((int)floor((max.x - this->origin.x) / this->cellSize), 0, this->cols - 1);
+	range.z1 = clamp((int)floor((max.z - this->origin.y) / this->cellSize), 0, this->rows - 1);
+
+	return range;
+} // GET RANGE
+
+// ========================================
+
+void SpatialGrid::link(Object *obj, CellRange range)
+{
+	for (int z = range.z0; z <= range.z1; z++)
+		for (int x = range.x0; x <= range.x1; x++)
+			this->cells[z * this->cols + x].push_back(obj);
+} // LINK
+
+// ========================================
+
+void SpatialGrid::unlink(Object *obj, CellRange range)
+{
+	for (int z = range.z0; z <= range.z1; z++)
+		for (int x = range.x0; x <= range.x1; x++)
+		{
+			vector <Object*> &cell = this->cells[z * this->cols + x];
+			auto it = find(cell.begin(), cell.end(), obj);
+			if (it != cell.end())
+			{
+				*it = cell.back(); // order in the cell does not matter
+				cell.pop_back();
+			} // if
+		} // for
+} // UNLINK
+
+// ========================================
+
+void SpatialGrid::insert(Object *obj)
+{
+	if (!obj || this->ranges.count(obj)) return;
+
+	vec3 min, max;
+	obj->getBounds(min, max);
+
+	CellRange range = this->getRange(min, max);
+	this->ranges[obj] = range;
+	this->link(obj, range);
+} // INSERT
+
+// ========================================
+
+/** Moves the object into new cells, nothing happens while it stays in the same ones. */
+void SpatialGrid::update(Object *obj)
+{
+	auto it = this->ranges.find(obj);
+	if (it == this->ranges.end()) return;
+
+	vec3 min, max;
+	obj->getBounds(min, max);
+
+	CellRange range = this->getRange(min, max);
+	if (range == it->second) return;
+
+	this->unlink(obj, it->second);
+	this->link(obj, range);
+	it->second = range;
+} // UPDATE
+
+// ========================================
+
+void SpatialGrid::remove(Object *obj)
+{
+	auto it = this->ranges.find(obj);
+	if (it == this->ranges.end()) return;
+
+	this->unlink(obj, it->second);
+	this->ranges.erase(it);
+} // REMOVE
+
+// ========================================
+
+void SpatialGrid::clear()
+{
+	for (auto &cell : this->cells)
+		cell.clear();
+	this->ranges.clear();
+} // CLEAR
+
+// ========================================
+
+/** Collects every object whose cells overlap the box (each object only once, ordered by its slot in the store). */
+void SpatialGrid::query(vec3 min, vec3 max, vector <Object*> &result)
+{
+	CellRange range = this->getRange(min, max);
+	size_t first = result.size();
+
+	for (int z = range.z0; z <= range.z1; z++)
+		for (int x = range.x0; x <= range.x1; x++)
+		{
+			const vector <Object*> &cell = this->cells[z * this->cols + x];
+			result.insert(result.end(), cell.begin(), cell.end());
+		} // for
+
+	// objects spanning more cells were found several times, slots of the store give the same order in every run (addresses do not)
+	sort(result.begin() + first, result.end(), [](Object *a, Object *b) {return a->getHandle().index < b->getHandle().index;});
+	result.erase(unique(result.begin() + first, result.end()), result.end());
+} // QUERY
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#include "pgr.h"
+
+using namespace std;
+using namespace glm;
+
+// ========================================
+
+/** Node of 32 bytes, two of them fit into one cache line. */
+struct BvhNode
+{
+	vec3 min;
+	unsigned int first; // left child (inner node) or first triangle (leaf)
+	vec3 max;
+	unsigned int count; // zero for inner node
+};
+
+// ========================================
+
+class Bvh
+{
+	private:
+
+		vector <vec3> triangles; // three vertices per triangle, sorted by leaves
+		vector <BvhNode> nodes;
+
+		void subdivide(unsigned int node, vector <vec3> &centroids);
+
+	public:
+
+		const vector <vec3> &getTriangles();
+		const vector <BvhNode> &getNodes();
+		vec3 getMin();
+		vec3 getMax();
+
+		// ****************************************
+
+		bool isEmpty();
+		void addTriangles(const float *vertices, size_t stride, const unsigned int *indices, size_t count);
+		void build();
+		bool intersectRay(vec3 origin, vec3 dir, float &t);
+		bool overlapBox(vec3 center, mat3 axes);
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "pgr.h"
+#include "headers/target.h"
+
+// ========================================
+
+class StaticCache
+{
+	private:
+
+		RenderTarget *target;
+		bool valid;
+		int view;
+		float scale;
+
+	public:
+
+		StaticCache(int width, int height);
+		~StaticCache();
+
+		// ****************************************
+
+		RenderTarget *getTarget();
+
+		// ****************************************
+
+		bool isValid(int view, float scale);
+		void invalidate();
+		void resize(int width, int height);
+		void store(RenderTarget *from, int width, int height, int view, float scale);
+		void restore(RenderTarget *to, int width, int height);
+};
@@ -10,8 +10,9 @@ class Camera
 {
 	private:
 
-		Object **plane;
+		EntityHandle plane; // flown plane, it resolves to nothing once the plane is destroyed
 		vec3 pos, defPos, dir, defDir, up, defUp;
+		vec3 prevPos, prevDir, prevUp; // state of the previous simulation step
 		mat4 vMatrix;
 		float speed, angleX, angleY, startTime;
 
@@ -21,8 +22,8 @@ class Camera
 
 		// ****************************************
 
-		Object **getPlane();
-		void setPlane(Object **plane);
+		Object *getPlane();
+		void setPlane(Object *plane);
 
 		vec3 getPos();
 		void setPos(vec3 pos);
@@ -43,6 +44,7 @@ class Camera
 		void setDefUp(vec3 defUp);
 
 		mat4 getVMatrix();
+		mat4 getVMatrix(float alpha);
 		void setVMatrix(vec3 eye, vec3 center, vec3 up);
 
 		float getSpeed();
@@ -59,9 +61,10 @@ class Camera
 
 		// ****************************************
 
-		bool interactWithPlane(Object **jetPlane, Object **fighterPlane, Object **retroPlane);
+		void saveState();
+		bool interactWithPlane(Object *jetPlane, Object *fighterPlane, Object *retroPlane);
 		void updatePosWhileWalking(State *state);
 		void updatePosWhileFlying(State *state);
 		void updateAngle();
-		void update(State *state, const vec3 *curveData, size_t curveSize);
+		void update(State *state, SplinePath *path);
 };
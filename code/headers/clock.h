@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+
+using namespace std;
+
+// ========================================
+
+/** Source of time for the simulation loop, the window runs on the wall clock, headless runs may warp or skip it. */
+class Clock
+{
+	public:
+
+		virtual ~Clock() {};
+
+		virtual double getTime() = 0; // seconds of the simulated world
+		virtual void wait(double duration) = 0; // until the time moves on by the duration
+};
+
+// ========================================
+
+/** Wall clock sped up (or slowed down) by the warp factor. */
+class WallClock : public Clock
+{
+	private:
+
+		double start, warp;
+
+	public:
+
+		WallClock(double warp = 1.0);
+
+		double getTime() override;
+		void wait(double duration) override;
+};
+
+// ========================================
+
+/** Clock which only moves when somebody waits for it, so the simulation runs as fast as the CPU allows. */
+class ManualClock : public Clock
+{
+	private:
+
+		double time;
+
+	public:
+
+		ManualClock();
+
+		double getTime() override;
+		void wait(double duration) override;
+};
+
+// ========================================
+
+/** Durations of simulation steps for the statistics of headless runs. */
+class StepTimer
+{
+	private:
+
+		vector <double> durations; // seconds
+		double total;
+
+	public:
+
+		StepTimer();
+
+		size_t getCount();
+		double getTotal();
+		double getMean();
+		double getMax();
+		double getPercentile(double percent);
+
+		void add(double duration);
+};
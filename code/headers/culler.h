@@ -0,0 +1,36 @@
+#pragma once
+
+#include <map>
+
+#include "pgr.h"
+#include "headers/mesh.h"
+
+using namespace std;
+using namespace glm;
+
+// ========================================
+
+class Culler
+{
+	private:
+
+		GLuint program;
+		Mesh *box;
+		map <int, GLuint> queries;
+		map <int, bool> visible;
+
+	public:
+
+		Culler(GLuint program);
+		~Culler();
+
+		// ****************************************
+
+		GLuint getProgram();
+		void setProgram(GLuint program);
+
+		// ****************************************
+
+		bool isVisible(int id);
+		void query(int id, vec3 pos, vec3 extent, vec3 eye, mat4 pMatrix, mat4 vMatrix);
+};
@@ -8,7 +8,28 @@ using namespace glm;
 constexpr auto WIN_WIDTH          = 1280;
 constexpr auto WIN_HEIGHT         = 720;
 constexpr auto WIN_TITLE          = "Airport";
-constexpr auto REFRESH_INTERVAL   = 10;
+constexpr auto SIM_STEP           = 0.01f;
+constexpr auto MAX_FRAME_TIME     = 0.25f;
+constexpr auto INPUT_QUEUE_SIZE   = 256;
+constexpr auto MAX_ENTITIES       = 8192;
+constexpr auto HELICOPTER_SPEED   = 17.0f;
+constexpr auto EXHIBITION_SPEED   = 6.0f;
+constexpr auto TRAFFIC_AIRCRAFT   = 6000;
+constexpr auto TRAFFIC_RESERVE    = 256; // slots of the store kept for the scene, the scheduler and the explosions
+constexpr auto TRAFFIC_SEED       = 2022u;
+constexpr auto TRAFFIC_SPAWN_RATE = 20;
+constexpr auto TRAFFIC_MAX_LAPS   = 3;
+constexpr auto TRAFFIC_SPREAD     = 60.0f;
+constexpr auto TRAFFIC_STACK      = 40.0f;
+constexpr auto TRAFFIC_LOD_DIST   = 40.0f;
+constexpr auto TRAFFIC_RADIUS     = 1.75f;
+constexpr auto ARRIVALS_PER_HOUR  = 12.0f;
+constexpr auto DEPARTS_PER_HOUR   = 12.0f;
+constexpr auto SCHEDULER_SEED     = 1989u;
+constexpr auto TAXI_SPEED         = 3.0f;
+constexpr auto ROLL_SPEED         = 10.0f;
+constexpr auto APPROACH_SPEED     = 15.0f;
+constexpr auto CLIMB_SPEED        = 15.0f;
 constexpr auto REAL_CAM_SPEED     = 0.05f;
 constexpr auto FREE_CAM_SPEED     = 0.5f;
 constexpr auto TAKE_OFF_SPEED     = 0.3f;
@@ -16,11 +37,22 @@ constexpr auto CAMERA_ANGLE_MAX   = 90.0f;
 constexpr auto CAMERA_SENSITIVITY = 0.25f;
 constexpr auto SCENE_WIDTH        = 260.0f;
 constexpr auto SCENE_DEPTH        = 300.0f;
-constexpr auto ISLAND_WIDTH       = 20.0f;
-constexpr auto ISLAND_DEPTH       = 38.0f;
 constexpr auto ANGLE_INC          = 0.5f;
 constexpr auto MIST_DEN           = 0.05f;
 constexpr auto MIST_COL           = 0.4f;
+constexpr auto IMPOSTOR_DIST      = 60.0f;
+constexpr auto IMPOSTOR_FADE      = 10.0f;
+constexpr auto IMPOSTOR_RADIUS    = 1.75f;
+constexpr auto IMPOSTOR_FRAMES    = 8;
+constexpr auto IMPOSTOR_RES       = 128;
+constexpr auto FRAME_BUDGET       = 8.0f;
+constexpr auto SCALE_STEP         = 1.0f / 32.0f; // coarse, so the static cache survives a steady scale
+constexpr auto SHARPNESS          = 0.5f;
+constexpr auto GRID_CELL_SIZE     = 10.0f;
+constexpr auto TERRAIN_CELL_SIZE  = 0.5f;
+constexpr auto SEA_LEVEL          = -0.5f;
+constexpr auto EYE_HEIGHT         = 0.5f;
+constexpr auto GROUND_NORMAL_MIN  = 0.7f;
 
 // shaders
 constexpr auto VS_MAIN_SRC      = "shaders/fragLight.vert";
@@ -31,6 +63,16 @@ constexpr auto VS_EXPLOSION_SRC = "shaders/explosion.vert";
 constexpr auto FS_EXPLOSION_SRC = "shaders/explosion.frag";
 constexpr auto VS_GAME_OVER_SRC = "shaders/gameOver.vert";
 constexpr auto FS_GAME_OVER_SRC = "shaders/gameOver.frag";
+constexpr auto VS_OCCLUSION_SRC = "shaders/occlusion.vert";
+constexpr auto FS_OCCLUSION_SRC = "shaders/occlusion.frag";
+constexpr auto VS_IMPOSTOR_SRC  = "shaders/impostor.vert";
+constexpr auto FS_IMPOSTOR_SRC  = "shaders/impostor.frag";
+constexpr auto VS_UPSCALE_SRC   = "shaders/upscale.vert";
+constexpr auto FS_UPSCALE_SRC   = "shaders/upscale.frag";
+constexpr auto VS_INSTANCED_SRC = "shaders/instanced.vert";
+constexpr auto VS_INST_IMP_SRC  = "shaders/instancedImpostor.vert";
+constexpr auto VS_HUD_SRC       = "shaders/hud.vert";
+constexpr auto FS_HUD_SRC       = "shaders/hud.frag";
 
 // models
 constexpr auto ISLAND_MODEL_SRC     = "data/models/island/island.obj";
@@ -73,6 +115,7 @@ constexpr auto VERT_DIF_VAR = "vertDif";
 constexpr auto VERT_SPE_VAR = "vertSpe";
 constexpr auto VERT_SHI_VAR = "vertShi";
 constexpr auto VERT_POS_VAR = "vertPos";
+constexpr auto VERT_COL_VAR = "vertCol";
 constexpr auto VERT_NOR_VAR = "vertNor";
 constexpr auto TEX_COO_VAR  = "texCoo";
 constexpr auto TEX_SAM_VAR  = "texSam";
@@ -83,6 +126,18 @@ constexpr auto FLA_ON_VAR   = "flaOn";
 constexpr auto MIST_ON_VAR  = "mistOn";
 constexpr auto TEX_ON_VAR   = "texOn";
 constexpr auto TIME_VAR     = "time";
+constexpr auto FADE_VAR     = "fade";
+constexpr auto OBJ_ID_VAR   = "objId";
+constexpr auto FRAME_VAR    = "frame";
+constexpr auto FRAMES_VAR   = "frames";
+constexpr auto SCALE_VAR    = "scale";
+constexpr auto TEXEL_VAR    = "texel";
+constexpr auto SHARP_VAR    = "sharpness";
+constexpr auto SCREEN_VAR   = "screen";
+
+// per instance attributes (bound explicitly in the shaders)
+constexpr auto INST_MAT_LOC   = 3; // 4 columns
+constexpr auto INST_FRAME_LOC = 7;
 
 // axis
 const auto X_AXIS = vec3(1.0f, 0.0f, 0.0f);
@@ -90,6 +145,9 @@ const auto Y_AXIS = vec3(0.0f, 1.0f, 0.0f);
 const auto Z_AXIS = vec3(0.0f, 0.0f, 1.0f);
 const auto XZ_AXIS = normalize(X_AXIS + Z_AXIS);
 
+// sun position
+const auto SUN_POS = vec3(-0.5f, 1.0f, -1.0f);
+
 // camera default position
 const auto CAM_DEF_POS = vec3(-1.0f, 0.5f, 28.0f);
 const auto CAM_DEF_DIR = -Z_AXIS;
@@ -108,6 +166,9 @@ const auto RUNWAY_CAM_UP = vec3(0.000532712f, 0.998135f, -0.0610462f);
 // key map
 enum {KEY_W, KEY_S, KEY_A, KEY_D, KEY_E, KEY_Q, KEY_UP, KEY_DOWN, KEY_LEFT, KEY_RIGHT, KEYS_COUNT};
 
+// static camera views
+enum {VIEW_NONE, VIEW_TOWER, VIEW_RUNWAY};
+
 // ========================================
 
 // curves data
@@ -136,6 +197,62 @@ static const vec3 airportExhCurveData[] =
   vec3(11.2f, 1.0f,  29.0f)
 };
 
+// first and last points only shape the ends of open routes
+const size_t arrivalCurveSize = 8;
+static const vec3 arrivalCurveData[] =
+{
+  vec3(10.9f, 60.0f, 280.0f),
+  vec3(10.9f, 50.0f, 220.0f),
+  vec3(10.9f, 28.0f, 130.0f),
+  vec3(10.9f,  9.0f,  75.0f),
+  vec3(10.9f,  0.6f,  38.0f),
+  vec3(10.9f,  0.6f,   5.0f),
+  vec3(10.9f,  0.6f, -25.0f),
+  vec3(10.9f,  0.6f, -45.0f)
+};
+
+const size_t departureCurveSize = 8;
+static const vec3 departureCurveData[] =
+{
+  vec3( 10.9f,  0.6f,   50.0f),
+  vec3( 10.9f,  0.6f,   35.0f),
+  vec3( 10.9f,  0.6f,    0.0f),
+  vec3( 10.9f,  4.0f,  -35.0f),
+  vec3( 10.9f, 20.0f,  -90.0f),
+  vec3( 30.0f, 45.0f, -170.0f),
+  vec3( 70.0f, 70.0f, -240.0f),
+  vec3(100.0f, 80.0f, -280.0f)
+};
+
+const size_t holdingCurveSize = 8;
+static const vec3 holdingCurveData[] =
+{
+  vec3(  10.0f, 45.0f,  130.0f),
+  vec3(  90.0f, 45.0f,   90.0f),
+  vec3( 110.0f, 45.0f,    0.0f),
+  vec3(  90.0f, 45.0f,  -90.0f),
+  vec3(  10.0f, 45.0f, -130.0f),
+  vec3( -70.0f, 45.0f,  -90.0f),
+  vec3( -90.0f, 45.0f,    0.0f),
+  vec3( -70.0f, 45.0f,   90.0f)
+};
+
+// places of the runway scheduler (in the order of NODE_* in scheduler.h)
+static const vec3 taxiNodeData[] =
+{
+  vec3(-8.5f,  0.0f,  18.5f), // hangar 0
+  vec3(-8.5f,  0.0f,   8.0f), // hangar 1
+  vec3(-1.0f,  0.0f,  18.5f), // junction 0
+  vec3(-1.0f,  0.0f,   8.0f), // junction 1
+  vec3(-1.0f,  0.0f,  38.0f), // hold short
+  vec3(10.9f,  0.0f,  38.0f), // threshold
+  vec3(10.9f,  0.0f, -27.0f), // runway exit
+  vec3(-1.0f,  0.0f, -27.0f), // taxiway exit
+  vec3(10.9f, 10.0f, 110.0f), // approach
+  vec3(10.9f,  0.0f, -15.0f), // lift off
+  vec3(10.9f, 15.0f, -90.0f)  // climb
+};
+
 // ========================================
 
 // textures data
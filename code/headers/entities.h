@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+
+#include "pgr.h"
+#include "headers/jobs.h"
+
+using namespace std;
+using namespace glm;
+
+class Object;
+
+// ========================================
+
+/** Stable reference to an entity, it stops resolving when the entity is destroyed. */
+struct EntityHandle
+{
+	unsigned int index;
+	unsigned int generation; // 0 never belongs to a living entity
+
+	EntityHandle() : index(0), generation(0) {};
+	EntityHandle(unsigned int index, unsigned int generation) : index(index), generation(generation) {};
+
+	bool operator==(const EntityHandle &other) const
+	{
+		return (index == other.index) && (generation == other.generation);
+	} // OPERATOR ==
+};
+
+// ========================================
+
+/** Hot data of all objects as parallel arrays, slots never move, so the renderer may read the scenery meanwhile. */
+class EntityStore
+{
+	private:
+
+		static const size_t MATRIX_GRAIN = 256; // entities per job, a multiple of the batch of four
+		static const size_t COPY_GRAIN = 4096;
+
+		size_t capacity, highWater; // slots above the high water mark have never been used
+		size_t frozen; // slots below are never changed again (scenery)
+		vector <unsigned int> generations;
+		vector <unsigned int> freeSlots;
+		vector <Object*> owners;
+		vector <unsigned int> batch; // dirty entities of the last update
+
+		void buildMatrices(const unsigned int *indices, size_t count);
+		void saveStates(size_t begin, size_t end);
+
+	public:
+
+		// indexed by the handle index, read and written directly by sweeps over all entities
+		vector <vec3> pos, prevPos, dir, prevDir, angle, prevAngle, size, boundBox;
+		vector <float> currSpeed, maxSpeed, accel;
+
+		// model and normal matrices of the current step, valid while the entity is not dirty
+		vector <mat4> world, normal;
+		vector <unsigned char> dirty;
+		vector <unsigned char> custom; // matrix is built by the object itself (not by the batch)
+
+		EntityStore(size_t capacity);
+
+		// ****************************************
+
+		size_t getCapacity();
+		size_t getHighWater();
+		size_t getFrozen();
+		size_t getCount();
+
+		// ****************************************
+
+		EntityHandle create(Object *owner, vec3 pos, vec3 dir, vec3 size, vec3 boundBox, vec3 angle, float currSpeed, float maxSpeed, float accel);
+		void destroy(EntityHandle handle);
+		bool isAlive(EntityHandle handle);
+		Object* getOwner(EntityHandle handle);
+
+		void freeze();
+		void saveStates(JobSystem *jobs = nullptr);
+		void updateMatrices(JobSystem *jobs = nullptr);
+		void copyFrom(EntityStore &other);
+};
+
+mat4 getNormalMatrix(const mat4 &mMatrix);
+
+extern EntityStore* entities; // objects of the simulation and the scenery
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "pgr.h"
+#include "headers/object.h"
+
+using namespace std;
+using namespace glm;
+
+// ========================================
+
+/** Cells covered by an object (both bounds included). */
+struct CellRange
+{
+	int x0, z0, x1, z1;
+
+	bool operator==(const CellRange &other) const
+	{
+		return (x0 == other.x0) && (z0 == other.z0) && (x1 == other.x1) && (z1 == other.z1);
+	} // OPERATOR ==
+};
+
+// ========================================
+
+/** Uniform grid over the ground plane, objects are stored in all cells their bounding boxes overlap. */
+class SpatialGrid
+{
+	private:
+
+		vec2 origin; // corner of the grid
+		float cellSize;
+		int cols, rows;
+
+		vector <vector <Object*>> cells;
+		map <Object*, CellRange> ranges;
+
+		CellRange getRange(vec3 min, vec3 max);
+		void link(Object *obj, CellRange range);
+		void unlink(Object *obj, CellRange range);
+
+	public:
+
+		SpatialGrid(float width, float depth, float cellSize);
+
+		// ****************************************
+
+		float getCellSize();
+		int getCols();
+		int getRows();
+		size_t getCount();
+
+		// ****************************************
+
+		void insert(Object *obj);
+		void update(Object *obj);
+		void remove(Object *obj);
+		void clear();
+		void query(vec3 min, vec3 max, vector <Object*> &result);
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+#include "pgr.h"
+#include "headers/jobs.h"
+#include "headers/object.h"
+
+using namespace std;
+using namespace glm;
+
+// ========================================
+
+/** Ground heights on a regular grid with min/max pyramid for fast segment tests. */
+class Heightfield
+{
+	private:
+
+		vec2 origin; // position of the first sample
+		float cellSize;
+		int cols, rows; // samples
+
+		vector <float> heights;
+		vector <vector <vec2>> pyramid; // min and max height of cells, level 0 holds single cells
+		vector <int> levelCols, levelRows;
+
+		float getSample(int x, int z);
+		void buildPyramid();
+		bool intersectNode(int level, int x, int z, vec3 from, vec3 move, float &t);
+		bool intersectCell(int x, int z, vec3 from, vec3 move, float &t);
+
+	public:
+
+		Heightfield(vec2 min, vec2 max, float cellSize);
+
+		// ****************************************
+
+		float getCellSize();
+		int getCols();
+		int getRows();
+		float getMinHeight();
+		float getMaxHeight();
+
+		// ****************************************
+
+		void sample(vector <Object*> &ground, float top, float bottom, JobSystem *jobs);
+		float getHeight(float x, float z);
+		vec3 getNormal(float x, float z);
+		bool intersectSegment(vec3 from, vec3 to, float &t);
+};
@@ -1,15 +1,23 @@
 #pragma once
 
+#include <chrono>
 #include <iostream>
 
+#include "headers/bvh.h"
 #include "headers/camera.h"
 #include "headers/data.h"
+#include "headers/grid.h"
+#include "headers/heightfield.h"
+#include "headers/jobs.h"
 
 using namespace pgr;
 using namespace Assimp;
 
 extern Camera* cam;
 extern State* state;
+extern SpatialGrid* grid;
+extern Heightfield* heightfield;
+extern JobSystem* jobs;
 
 extern vector <Object*> stones;
 extern vector <Object*> hangars;
@@ -49,8 +57,17 @@ void deleteVector(vector <T*> &vect)
 
 // ========================================
 
-void loadModel(const string &filename, GLuint program, vector <Mesh*> &model);
+double getWallTime();
+void loadModel(const string &filename, GLuint program, vector <Mesh*> &model, Bvh *bvh = nullptr, Job *group = nullptr);
+unsigned int castRay(vector <Object*> &objects, vec3 origin, vec3 dir);
+void destroyObject(Object **obj);
+void crashPlane(Object *plane);
+float getGroundLevel(Object *obj);
 bool checkComplexCollision(vec3 myPos, vec3 myBoundBox, vec3 objPos, vec3 objBoundBox, vec3 objInBox);
 bool checkTrivialCollision(vec3 myPos, vec3 myBoundBox, vec3 objPos, vec3 objBoundBox);
+bool checkMeshCollision(Object *me, Object *obj);
+bool checkObjectCollision(Object *me, vec3 myPos, vec3 myBoundBox, Object *obj);
+float sweepCollisions(Object *me, vec3 from, vec3 to);
 bool checkCollisions(vec3 myPos, vec3 myBoundBox);
-bool checkBounds(Object **obj);
+bool checkTerrain(Object *obj, vec3 from, vec3 to);
+bool checkBounds(Object *obj);
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "pgr.h"
+
+using namespace std;
+using namespace glm;
+
+// ========================================
+
+/** Work sent to the GPU during the current frame, counted right where it is sent. */
+struct RenderStats
+{
+	unsigned int drawCalls, triangles, stateChanges, uniforms, textureBinds;
+
+	void clear();
+	void addProgram(unsigned int uniforms); // program bind with the uniforms sent to it
+	void addTexture(); // texture bind with its sampler uniform
+	void addDraw(GLenum mode, GLsizei count, GLsizei instances = 1); // vertex array bind with the draw call
+};
+
+extern RenderStats renderStats; // render thread only
+
+// ========================================
+
+/** Overlay with the frame rate, the frame time graph and the counters of the renderer, all drawn by one call. */
+class Hud
+{
+	private:
+
+		static const int GRAPH_FRAMES = 120; // bars of the frame time graph
+
+		struct Vertex
+		{
+			float x, y; // pixels from the top left corner
+			float r, g, b, a;
+		};
+
+		GLuint program, vao, buffer;
+		size_t capacity; // vertices the buffer has room for
+		vector <Vertex> vertices;
+
+		float frameTimes[GRAPH_FRAMES]; // ms
+		int next;
+		double lastTime;
+		bool gpuMemoryOn; // GL_NVX_gpu_memory_info is available
+
+		void addQuad(float x, float y, float w, float h, vec4 color);
+		void addText(const string &text, float x, float y, vec4 color);
+		float getGpuMemory();
+
+	public:
+
+		Hud(GLuint program);
+		~Hud();
+
+		// ****************************************
+
+		float getFps();
+
+		// ****************************************
+
+		void update();
+		void draw(const RenderStats &stats, float simTime, int winW, int winH);
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "pgr.h"
+#include "headers/mesh.h"
+
+using namespace std;
+using namespace glm;
+
+// ========================================
+
+class Impostor
+{
+	private:
+
+		GLuint program, fbo, texture, depth;
+		Mesh *quad;
+		int frames /* views per atlas side */, resolution /* pixels per view */;
+
+	public:
+
+		Impostor(GLuint program, int frames, int resolution);
+		~Impostor();
+
+		// ****************************************
+
+		GLuint getProgram();
+		void setProgram(GLuint program);
+
+		GLuint getTexture();
+
+		int getFrames();
+		int getResolution();
+
+		// ****************************************
+
+		void bake(GLuint program, vector <Mesh*> &model, vec3 sunPos);
+		void getView(mat4 mMatrix, vec3 eye, mat4 faceMatrix, mat4 &quadMatrix, vec2 &frame);
+		void draw(mat4 mMatrix, unsigned int id, float fade, mat4 pMatrix, mat4 vMatrix);
+};
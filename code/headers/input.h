@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+
+#include "pgr.h"
+
+using namespace std;
+using namespace glm;
+
+// ========================================
+
+enum {INPUT_KEY_DOWN, INPUT_KEY_UP, INPUT_SPECIAL_DOWN, INPUT_SPECIAL_UP, INPUT_MOTION, INPUT_PICK, INPUT_RAY};
+
+/** Event of a window callback waiting for the simulation. */
+struct InputEvent
+{
+	int type;
+	int key; // key or mouse shift
+	int x, y;
+	unsigned int id; // picked object
+	vec3 origin, dir; // picking ray
+};
+
+// ========================================
+
+/** Lock-free ring buffer for one producer and one consumer thread. */
+template <typename T, size_t SIZE>
+class SpscQueue
+{
+	private:
+
+		T items[SIZE];
+		atomic <size_t> head; // written only by the consumer
+		atomic <size_t> tail; // written only by the producer
+
+	public:
+
+		SpscQueue() : head(0), tail(0) {};
+
+		// ****************************************
+
+		/** Adds the item, returns false when the queue is full. */
+		bool push(const T &item)
+		{
+			size_t tail = this->tail.load(memory_order_relaxed);
+			size_t next = (tail + 1) % SIZE;
+			if (next == this->head.load(memory_order_acquire)) return false;
+
+			this->items[tail] = item;
+			this->tail.store(next, memory_order_release);
+			return true;
+		} // PUSH
+
+		/** Removes the oldest item, returns false when the queue is empty. */
+		bool pop(T &item)
+		{
+			size_t head = this->head.load(memory_order_relaxed);
+			if (head == this->tail.load(memory_order_acquire)) return false;
+
+			item = this->items[head];
+			this->head.store((head + 1) % SIZE, memory_order_release);
+			return true;
+		} // POP
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+#include "pgr.h"
+#include "headers/impostor.h"
+#include "headers/mesh.h"
+
+using namespace std;
+using namespace glm;
+
+// ========================================
+
+/** Draws many copies of a model or of its impostor with one call per mesh, instance data are streamed every frame. */
+class Instancer
+{
+	private:
+
+		GLuint modelProgram, impostorProgram, buffer;
+		Mesh *quad; // attributes of the impostor program
+		vector <mat4> matrices;
+		vector <vec2> frames;
+
+		// view of the current frame
+		mat4 pMatrix, vMatrix, faceMatrix;
+		vec3 eye;
+		vec4 planes[6];
+
+		void upload(const vector <mat4> &matrices, const vector <vec2> *frames);
+		void bindInstances(GLuint vao, size_t count, bool withFrames);
+		void unbindInstances(bool withFrames);
+
+	public:
+
+		Instancer(GLuint modelProgram, GLuint impostorProgram);
+		~Instancer();
+
+		// ****************************************
+
+		GLuint getModelProgram();
+		GLuint getImpostorProgram();
+		vec3 getEye();
+
+		// ****************************************
+
+		void begin(mat4 pMatrix, mat4 vMatrix);
+		bool isVisible(vec3 pos, float radius);
+
+		void drawModels(vector <Mesh*> &model, const vector <mat4> &instances);
+		void drawImpostors(Impostor *impostor, const vector <mat4> &instances);
+};
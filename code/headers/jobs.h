@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// ========================================
+
+/** Piece of work, it is finished when its task and all its children are done. */
+struct Job
+{
+	function <void()> task;
+	Job *parent;
+	bool mainThread; // has to run on the thread with the GL context
+	bool autoDelete; // deleted by the system after finishing (nobody waits for it)
+
+	atomic <int> unfinished; // own task + children
+	atomic <int> pendingDeps; // jobs this one waits for before it may start
+
+	mutex depMutex;
+	vector <Job*> dependents; // jobs waiting for this one
+	bool released; // dependents have been handed over
+	atomic <bool> done;
+};
+
+// ========================================
+
+/** Queue of one worker, the owner takes from the back and the others steal from the front. */
+struct WorkQueue
+{
+	mutex lock;
+	deque <Job*> jobs;
+};
+
+// ========================================
+
+/** Work-stealing scheduler for tasks of one frame, GL calls go through the main thread lane. */
+class JobSystem
+{
+	private:
+
+		vector <thread> workers;
+		vector <WorkQueue*> queues; // one per worker + one for other threads
+		WorkQueue mainQueue; // executed only by the main thread
+
+		atomic <bool> running;
+		atomic <int> queued; // jobs waiting in worker queues
+		mutex sleepLock;
+		condition_variable wakeUp;
+
+		thread::id mainThreadId;
+
+		void workerLoop(int index);
+		void push(Job *job);
+		Job* pop(int index);
+		void execute(Job *job);
+		void finish(Job *job);
+
+	public:
+
+		JobSystem(unsigned int numWorkers = 0);
+		~JobSystem();
+
+		// ****************************************
+
+		int getNumWorkers();
+		bool isMainThread();
+
+		// ****************************************
+
+		Job* create(function <void()> task, Job *parent = nullptr, bool mainThread = false);
+		void addDependency(Job *job, Job *dependsOn);
+		void run(Job *job);
+		void spawn(function <void()> task, Job *parent);
+		void wait(Job *job);
+
+		void parallelFor(size_t count, size_t grain, function <void(size_t, size_t)> task);
+		void runOnMainThread(function <void()> task);
+		void runMainJobs();
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "headers/input.h"
+
+using namespace std;
+
+// ========================================
+
+/** Inputs of a run with the simulation steps they were applied before, replaying them repeats the run exactly. */
+class InputJournal
+{
+	private:
+
+		static const unsigned int VERSION = 1;
+
+		struct Entry
+		{
+			unsigned int step;
+			InputEvent event;
+		};
+
+		vector <Entry> entries;
+		size_t replayed; // entries handed out so far
+		unsigned int steps; // length of the recorded run
+		unsigned int trafficSeed, schedulerSeed;
+		bool replaying;
+
+	public:
+
+		InputJournal(unsigned int trafficSeed, unsigned int schedulerSeed); // empty one for recording
+		InputJournal(); // filled by load for replaying
+
+		// ****************************************
+
+		bool isReplaying();
+		unsigned int getSteps();
+		unsigned int getTrafficSeed();
+		unsigned int getSchedulerSeed();
+
+		// ****************************************
+
+		void record(unsigned int step, const InputEvent &event);
+		bool next(unsigned int step, InputEvent &event);
+
+		bool save(const string &filename, unsigned int steps);
+		bool load(const string &filename);
+};
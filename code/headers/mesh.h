@@ -54,4 +54,6 @@ class Mesh
 		void createSpotLightMesh(GLuint program);
 		void createExplosionMesh(GLuint program);
 		void createGameOverMesh(GLuint program);
+		void createBoundBoxMesh(GLuint program);
+		void createImpostorMesh(GLuint program);
 };
@@ -1,17 +1,33 @@
 #pragma once
 
 #include "pgr.h"
+#include "headers/entities.h"
+#include "headers/path.h"
 #include "headers/state.h"
 #include "headers/mesh.h"
 
+class Impostor;
+class Bvh;
+
 // ========================================
 
 class Object
 {
 	protected:
 
-		vec3 defPos, pos, defDir, dir, size, boundBox, defAngle, angle;
-		float currSpeed, maxSpeed, accel, startTime, currTime;
+		EntityStore *store; // hot data (position, direction, angle, size, speeds) of this and previous step
+		EntityHandle handle;
+		bool owner; // copies only look at the entity
+
+		vec3 defPos, defDir, inBox, defAngle;
+		float startTime, currTime;
+		Impostor *impostor;
+		Bvh *bvh; // for ray casting
+		unsigned int id; // for picking
+
+		bool isMoving();
+		void drawModel(GLuint program, vector <Mesh*> &model, mat4 pMatrix, mat4 vMatrix, mat4 mMatrix, mat4 nMatrix);
+		virtual mat4 transform(vec3 pos, vec3 dir, vec3 angle);
 
 	public:
 
@@ -19,12 +35,20 @@ class Object
 		(
 			vec3 pos, vec3 dir, vec3 size, vec3 boundBox, vec3 angle,
 			float currSpeed = 0.0f, float maxSpeed = 0.0f, float accel = 0.0f, float startTime = 0.0f
-		)
-		: defPos(pos), pos(pos), defDir(dir), dir(dir), size(size), boundBox(boundBox), defAngle(angle), angle(angle),
-			currSpeed(currSpeed), maxSpeed(maxSpeed), accel(accel), startTime(startTime), currTime(startTime) {};
+		);
+		Object(const Object &other);
+		Object &operator=(const Object &other);
+		virtual ~Object();
+
+		static float alpha; // progress between the last two simulation steps (for drawing)
 
 		// ****************************************
 
+		EntityStore *getStore();
+		void setStore(EntityStore *store);
+
+		EntityHandle getHandle();
+
 		vec3 getDefPos();
 		void setDefPos(vec3 defPos);
 
@@ -40,6 +64,9 @@ class Object
 		vec3 getBoundBox();
 		void setBoundBox(vec3 boundBox);
 
+		vec3 getInBox();
+		void setInBox(vec3 inBox);
+
 		vec3 getAngle();
 		void setAngle(vec3 angle);
 
@@ -58,10 +85,23 @@ class Object
 		float getCurrTime();
 		void setCurrTime(float currTime);
 
+		Impostor *getImpostor();
+		void setImpostor(Impostor *impostor);
+
+		Bvh *getBvh();
+		void setBvh(Bvh *bvh);
+
+		unsigned int getId();
+		void setId(unsigned int id);
+
 		// ****************************************
 
+		mat4 getMMatrix();
+		mat4 getMMatrix(float alpha);
+		void saveState();
+		void getBounds(vec3 &min, vec3 &max);
 		bool isPlayerNearby(vec3 myPos);
-		void update(State* state, const vec3* curveData, size_t curveSize);
+		void update(SplinePath* path);
 		virtual void draw(GLuint program, vector <Mesh*> &model, mat4 pMatrix, mat4 vMatrix, mat4 mMatrix);
 };
 
@@ -75,11 +115,14 @@ class Helicopter : public Object
 		(
 			vec3 pos, vec3 dir, vec3 size, vec3 boundBox, vec3 angle,
 			float speed = 0.0f, float startTime = 0.0f
-		) : Object(pos, dir, size, boundBox, angle, speed, speed, speed, startTime) {};
+		) : Object(pos, dir, size, boundBox, angle, speed, speed, speed, startTime)
+		{
+			this->store->custom[this->handle.index] = 1; // aligned with the flight direction, not built by the batch
+		};
 
-		// ****************************************
+	protected:
 
-		void draw(GLuint program, vector <Mesh*> &model, mat4 pMatrix, mat4 vMatrix, mat4 mMatrix);
+		mat4 transform(vec3 pos, vec3 dir, vec3 angle);
 };
 
 // ========================================
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+
+#include "pgr.h"
+#include "headers/target.h"
+
+using namespace std;
+
+// build with OFFSCREEN_EGL (surfaceless Mesa, e.g. llvmpipe) or OFFSCREEN_OSMESA to get a backend
+
+// ========================================
+
+/** GL context without any window, frames end in a render target instead of the screen. */
+class OffscreenContext
+{
+	private:
+
+		int width, height;
+		void *display, *context; // EGL display and context or OSMesa context
+		unsigned char *buffer; // OSMesa needs a default frame buffer even when nothing is drawn into it
+		RenderTarget *screen;
+
+	public:
+
+		OffscreenContext(int width, int height);
+		~OffscreenContext();
+
+		// ****************************************
+
+		int getWidth();
+		int getHeight();
+		RenderTarget *getScreen();
+
+		// ****************************************
+
+		void createScreen(); // after the GL functions are loaded
+		bool savePng(const string &filename);
+};
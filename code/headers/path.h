@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+
+#include "pgr.h"
+#include "headers/jobs.h"
+
+using namespace std;
+using namespace glm;
+
+// ========================================
+
+/** Catmull-Rom path travelled with constant speed, everything expensive is precomputed. */
+class SplinePath
+{
+	private:
+
+		static const int LENGTH_STEPS = 32; // chords per segment for measuring
+		static const int TABLE_STEPS = 16; // entries of the distance table per segment
+
+		bool closed;
+		size_t numSegments;
+		float length, tableStep;
+
+		vector <vec3> coeffs; // a, b, c, d of each segment: ((a * t + b) * t + c) * t + d
+		vector <float> table; // curve parameter at uniformly spaced distances
+
+		void locate(float param, size_t &segment, float &t);
+
+	public:
+
+		SplinePath(const vec3 points[], size_t count, bool closed = true);
+
+		// ****************************************
+
+		bool isClosed();
+		size_t getNumSegments();
+		float getLength();
+		const vec3 *getCoeffs();
+
+		// ****************************************
+
+		float getParam(float distance);
+		const vec3 *getSegment(float distance, float &t);
+		vec3 evaluate(float param);
+		vec3 evaluateDerivative(float param);
+		vec3 evaluateSecondDerivative(float param);
+
+		vec3 getPos(float distance);
+		vec3 getTangent(float distance);
+		void getPosAndTangent(float distance, vec3 &pos, vec3 &tangent);
+		float getCurvature(float distance);
+};
+
+// ========================================
+
+/** Points of many paths evaluated at once, every component has its own array (structure of arrays). */
+struct PathBatch
+{
+	static const size_t GRAIN = 256; // points per job
+
+	vector <SplinePath*> paths;
+	vector <float> distances;
+	vector <float> posX, posY, posZ;
+	vector <float> dirX, dirY, dirZ; // unit tangents
+
+	void resize(size_t count);
+	size_t getCount();
+
+	void evaluate(size_t begin, size_t end);
+	void evaluate(JobSystem *jobs);
+};
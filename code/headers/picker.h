@@ -0,0 +1,31 @@
+#pragma once
+
+#include "pgr.h"
+#include "headers/target.h"
+
+// ========================================
+
+class Picker
+{
+	private:
+
+		GLuint pbo;
+		GLsync fence;
+		bool requested;
+		int x, y; // window coordinates from the bottom left corner
+
+	public:
+
+		Picker();
+		~Picker();
+
+		// ****************************************
+
+		bool isBusy();
+
+		// ****************************************
+
+		void request(int x, int y);
+		void read(RenderTarget *target, float scale);
+		bool poll(unsigned int &id);
+};
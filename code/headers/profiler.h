@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "pgr.h"
+
+using namespace std;
+
+// ========================================
+
+/** Last durations of one scope, percentiles are computed only when somebody asks. */
+class RollingStats
+{
+	private:
+
+		static const size_t WINDOW = 240; // samples kept (a few seconds of frames)
+
+		vector <float> samples; // ms
+		size_t next;
+
+	public:
+
+		RollingStats();
+
+		size_t getCount();
+		float getLast();
+		float getPercentile(float percent);
+
+		void add(float ms);
+};
+
+// ========================================
+
+/** Percentiles of one scope for printing or drawing. */
+struct ScopeSummary
+{
+	string path;
+	float cpu[3], gpu[3]; // p50, p95, p99 in ms (gpu zero when not measured)
+};
+
+// ========================================
+
+/** Durations of nested CPU scopes of all threads and of GPU scopes of the render thread, optionally kept as a trace. */
+class Profiler
+{
+	private:
+
+		static const int GPU_FRAMES = 3; // frames the GPU results may lag behind
+		static const int GPU_SCOPES = 32; // per frame
+		static const size_t MAX_TRACE = 1 << 20; // events kept for the trace
+
+		struct TraceEvent
+		{
+			const char *name;
+			double start, duration; // seconds since the profiler was created
+			int thread; // 0 for the GPU
+		};
+
+		mutex lock;
+		map <string, RollingStats> cpuStats, gpuStats;
+		map <int, string> threadNames;
+		vector <TraceEvent> trace;
+		bool tracing;
+		double origin;
+		atomic <int> numThreads;
+
+		// timestamp queries of the last frames, they are read when the GPU has finished them
+		bool gpuReady;
+		double gpuOffset; // seconds between the GPU and the profiler clock
+		GLuint queries[GPU_FRAMES][GPU_SCOPES][2];
+		string gpuPaths[GPU_FRAMES][GPU_SCOPES];
+		const char *gpuNames[GPU_FRAMES][GPU_SCOPES];
+		int gpuCount[GPU_FRAMES], frame;
+
+		void readGpu(int slot);
+
+	public:
+
+		Profiler(bool tracing);
+		~Profiler();
+
+		// ****************************************
+
+		bool isTracing();
+		double getTime();
+		int getThreadId();
+		void nameThread(const string &name);
+
+		// ****************************************
+
+		void initGpu();
+		void beginFrame();
+		int beginGpu(const char *name, const string &path);
+		void endGpu(int query);
+
+		void addCpu(const char *name, const string &path, double start, double end);
+
+		// ****************************************
+
+		float getLast(const string &path);
+		vector <ScopeSummary> getSummaries();
+		void printSummary(ostream &out);
+		bool writeTrace(const string &filename);
+};
+
+// ========================================
+
+/** Measures its own lifetime on the CPU (and on the GPU when asked), scopes nest by the thread they run in. */
+class ProfileScope
+{
+	private:
+
+		const char *name;
+		double start;
+		size_t pathLength;
+		int gpuQuery;
+
+	public:
+
+		ProfileScope(const char *name, bool gpu = false);
+		~ProfileScope();
+};
+
+extern Profiler* profiler; // nullptr switches all scopes off
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "pgr.h"
+#include "headers/target.h"
+
+// ========================================
+
+class Scaler
+{
+	private:
+
+		static const int QUERIES = 4; // frames the GPU may lag behind
+
+		GLuint program, vao, queries[QUERIES];
+		bool pending[QUERIES], measuring;
+		float scales[QUERIES]; // scale every query has measured
+		int current;
+		float scale, minScale, maxScale, budget /* ms */, gpuTime /* ms */;
+
+		void adapt(float measuredScale, float time);
+
+	public:
+
+		Scaler(GLuint program, float budget, float minScale = 0.5f, float maxScale = 1.0f);
+		~Scaler();
+
+		// ****************************************
+
+		float getScale();
+
+		float getBudget();
+		void setBudget(float budget);
+
+		float getGpuTime();
+
+		// ****************************************
+
+		void update();
+		void begin();
+		void end();
+		void present(RenderTarget *target, int winW, int winH, GLuint screen = 0);
+};
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <deque>
+#include <map>
+#include <queue>
+#include <vector>
+
+#include "pgr.h"
+#include "headers/entities.h"
+#include "headers/traffic.h"
+
+using namespace std;
+using namespace glm;
+
+// places of the airport (positions are in taxiNodeData)
+enum
+{
+	NODE_HANGAR_0, NODE_HANGAR_1, NODE_JUNCTION_0, NODE_JUNCTION_1, NODE_HOLD_SHORT, NODE_THRESHOLD,
+	NODE_RUNWAY_EXIT, NODE_TAXIWAY_EXIT, NODE_APPROACH, NODE_LIFT_OFF, NODE_CLIMB, NODES_COUNT
+};
+
+enum {MOVEMENT_ARRIVAL, MOVEMENT_DEPARTURE};
+enum {EVENT_SPAWN_ARRIVAL, EVENT_SPAWN_DEPARTURE, EVENT_LEG_END, EVENT_RUNWAY_CHECK};
+
+// ========================================
+
+/** Something what happens at the given time, equal times keep the order they were scheduled in. */
+struct Event
+{
+	double time;
+	unsigned long long sequence;
+	int type, movement;
+
+	bool operator>(const Event &other) const
+	{
+		return (time > other.time) || ((time == other.time) && (sequence > other.sequence));
+	} // OPERATOR >
+};
+
+// ========================================
+
+/** One landing or take off with the taxiing between the runway and a hangar. */
+struct Movement
+{
+	unsigned char type, kind;
+	vector <int> route; // nodes from the first to the last one
+	size_t leg; // moves from route[leg] to route[leg + 1]
+	bool moving; // false while it waits at route[leg] for the next leg
+	double legStart, legEnd, waitStart;
+	int segment; // taxi segment held (-1 for none)
+	bool onRunway;
+	EntityHandle handle; // drawn only when attached to a store
+};
+
+// ========================================
+
+/** Taxiway between two places, only one aircraft may use it, the others queue up. */
+struct Segment
+{
+	int from, to;
+	int occupant;
+	deque <int> waiting;
+};
+
+// ========================================
+
+struct SchedulerStats
+{
+	unsigned long long events;
+	size_t arrivals, departures; // finished ones
+	size_t maxRunwayQueue;
+	double runwayBusy; // seconds of occupied runway
+	double runwayDelay, taxiDelay; // seconds of waiting of all movements
+};
+
+// ========================================
+
+/** Discrete-event model of the runway and the taxiways, time jumps from event to event, so a day takes milliseconds. */
+class Scheduler
+{
+	private:
+
+		EntityStore *store; // nullptr in headless runs
+		double now;
+		unsigned long long sequence;
+		unsigned int seed;
+		float arrivalRate, departureRate; // movements per hour
+
+		priority_queue <Event, vector <Event>, greater <Event>> events;
+		vector <Movement> movements;
+		vector <int> freeMovements, active;
+
+		vector <Segment> segments;
+		map <pair <int, int>, int> segmentIds;
+
+		int runwayOccupant, lastRunwayType;
+		double runwayReleased, runwayGranted, runwayCheck;
+		vector <int> runwayQueue;
+
+		SchedulerStats stats;
+
+		float random();
+		void schedule(double time, int type, int movement);
+
+		int getSegment(int from, int to);
+		bool isRunwayLeg(const Movement &m, size_t leg);
+		float getLegSpeed(const Movement &m, size_t leg);
+
+		void spawn(int kind);
+		void request(int id);
+		void startLeg(int id);
+		void finish(int id);
+		void releaseSegment(int segment);
+		void releaseRunway();
+		void checkRunway();
+		void place(int id);
+
+	public:
+
+		Scheduler(EntityStore *store, float arrivalRate, float departureRate, unsigned int seed);
+		~Scheduler();
+
+		// ****************************************
+
+		double getTime();
+		size_t getActiveCount();
+		const SchedulerStats &getStats();
+
+		// ****************************************
+
+		void advance(double time);
+		void collect(vector <unsigned int> instances[TRAFFIC_TYPES_COUNT]);
+};
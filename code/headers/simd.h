@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1))
+	#define SIMD_SSE
+	#include <xmmintrin.h>
+#endif
+
+// ========================================
+
+#ifdef SIMD_SSE
+
+/** Four floats computed at once (one lane per entity or per path point). */
+struct Float4
+{
+	__m128 v;
+
+	Float4(__m128 v) : v(v) {};
+	Float4(float s) : v(_mm_set1_ps(s)) {};
+	Float4(const float *p) : v(_mm_load_ps(p)) {};
+
+	void store(float *p) {_mm_store_ps(p, v);}
+};
+
+static inline Float4 operator+(Float4 a, Float4 b) {return _mm_add_ps(a.v, b.v);}
+static inline Float4 operator-(Float4 a, Float4 b) {return _mm_sub_ps(a.v, b.v);}
+static inline Float4 operator*(Float4 a, Float4 b) {return _mm_mul_ps(a.v, b.v);}
+static inline Float4 operator-(Float4 a)           {return _mm_sub_ps(_mm_setzero_ps(), a.v);}
+static inline Float4 sqrt4(Float4 a)               {return _mm_sqrt_ps(a.v);}
+
+/** Reciprocal, zero stays zero (e.g. flat skybox). */
+static inline Float4 safeRcp(Float4 a)
+{
+	__m128 zero = _mm_setzero_ps();
+	return _mm_and_ps(_mm_div_ps(_mm_set1_ps(1.0f), a.v), _mm_cmpneq_ps(a.v, zero));
+} // SAFE RCP
+
+#else
+
+/** Four floats computed at once (plain fallback with the same interface). */
+struct Float4
+{
+	float v[4];
+
+	Float4() {};
+	Float4(float s) {for (int i = 0; i < 4; i++) v[i] = s;}
+	Float4(const float *p) {for (int i = 0; i < 4; i++) v[i] = p[i];}
+
+	void store(float *p) {for (int i = 0; i < 4; i++) p[i] = v[i];}
+};
+
+#define FLOAT4_OP(expr) Float4 r; for (int i = 0; i < 4; i++) r.v[i] = (expr); return r;
+static inline Float4 operator+(Float4 a, Float4 b) {FLOAT4_OP(a.v[i] + b.v[i])}
+static inline Float4 operator-(Float4 a, Float4 b) {FLOAT4_OP(a.v[i] - b.v[i])}
+static inline Float4 operator*(Float4 a, Float4 b) {FLOAT4_OP(a.v[i] * b.v[i])}
+static inline Float4 operator-(Float4 a)           {FLOAT4_OP(-a.v[i])}
+static inline Float4 sqrt4(Float4 a)               {FLOAT4_OP(std::sqrt(a.v[i]))}
+static inline Float4 safeRcp(Float4 a)             {FLOAT4_OP((a.v[i] != 0.0f) ? 1.0f / a.v[i] : 0.0f)}
+#undef FLOAT4_OP
+
+#endif
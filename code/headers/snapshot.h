@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "pgr.h"
+#include "headers/camera.h"
+#include "headers/data.h"
+#include "headers/entities.h"
+#include "headers/mesh.h"
+#include "headers/object.h"
+#include "headers/state.h"
+#include "headers/traffic.h"
+
+using namespace std;
+using namespace glm;
+
+// ========================================
+
+/** Aircraft copied with its model. */
+struct Vehicle
+{
+	Object object;
+	vector <Mesh*> *model;
+};
+
+// ========================================
+
+/** Everything the renderer needs from one simulation step (it is never changed after publishing). */
+struct Snapshot
+{
+	double time; // wall time of the current state, the previous one is one step older
+	unsigned int sceneVersion; // changes together with the static scene (lights, day, mist)
+
+	State state;
+	Camera cam;
+	vec3 flashlightPos, flashlightDir;
+	bool dayOn, flashlightOn, mistOn, planeModeOn;
+	int view;
+
+	EntityStore store; // moving entities, objects below look into it
+	vector <Helicopter> helicopter; // empty when destroyed
+	vector <Vehicle> planes;
+	vector <Explosion> explosions;
+	vector <GameOver> gameOver;
+
+	vector <unsigned int> traffic[TRAFFIC_TYPES_COUNT]; // store slots of AI aircraft by their models
+	size_t trafficCount;
+
+	Snapshot()
+	: time(0.0), sceneVersion(0), state(WIN_WIDTH, WIN_HEIGHT, 0), cam(CAM_DEF_POS, CAM_DEF_DIR, CAM_DEF_UP),
+		flashlightPos(CAM_DEF_POS), flashlightDir(CAM_DEF_DIR), dayOn(true), flashlightOn(false), mistOn(false), planeModeOn(false), view(VIEW_NONE),
+		store(MAX_ENTITIES), trafficCount(0) {};
+};
+
+// ========================================
+
+/** Lock-free exchange of the newest value between one writer and one reader, neither of them ever waits. */
+template <typename T>
+class TripleBuffer
+{
+	private:
+
+		static const int INDEX = 3;
+		static const int FRESH = 4; // middle buffer holds data the reader has not seen
+
+		T buffers[3];
+		atomic <int> middle;
+		int back, front;
+
+	public:
+
+		TripleBuffer() : middle(1), back(0), front(2) {};
+
+		// ****************************************
+
+		/** Buffer owned by the writer. */
+		T &getBack()
+		{
+			return this->buffers[this->back];
+		} // GET BACK
+
+		/** Buffer owned by the reader (valid until the next acquire). */
+		T &getFront()
+		{
+			return this->buffers[this->front];
+		} // GET FRONT
+
+		// ****************************************
+
+		/** Hands the back buffer over and takes the middle one for writing. */
+		void publish()
+		{
+			this->back = this->middle.exchange(this->back | FRESH, memory_order_acq_rel) & INDEX;
+		} // PUBLISH
+
+		/** Takes the newest published buffer, returns false when nothing new has come. */
+		bool acquire()
+		{
+			if (!(this->middle.load(memory_order_acquire) & FRESH)) return false;
+
+			this->front = this->middle.exchange(this->front, memory_order_acq_rel) & INDEX;
+			return true;
+		} // ACQUIRE
+};
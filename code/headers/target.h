@@ -0,0 +1,33 @@
+#pragma once
+
+#include "pgr.h"
+
+// ========================================
+
+class RenderTarget
+{
+	private:
+
+		GLuint fbo, color, ids, depth;
+		int width, height;
+
+	public:
+
+		RenderTarget(int width, int height);
+		~RenderTarget();
+
+		// ****************************************
+
+		GLuint getFbo();
+		GLuint getColor();
+		GLuint getIds();
+		GLuint getDepth();
+
+		int getWidth();
+		int getHeight();
+
+		// ****************************************
+
+		void resize(int width, int height);
+		void copy(RenderTarget *to, int width, int height);
+};
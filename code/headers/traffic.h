@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+
+#include "pgr.h"
+#include "headers/entities.h"
+#include "headers/jobs.h"
+#include "headers/path.h"
+
+using namespace std;
+using namespace glm;
+
+// models of the AI aircraft
+enum {TRAFFIC_JET, TRAFFIC_FIGHTER, TRAFFIC_RETRO, TRAFFIC_HELICOPTER, TRAFFIC_TYPES_COUNT};
+
+// patterns flown around the airport
+enum {ROUTE_ARRIVAL, ROUTE_DEPARTURE, ROUTE_HOLDING, ROUTES_COUNT};
+
+// ========================================
+
+/** One AI aircraft, its hot data lives in the entity store. */
+struct Aircraft
+{
+	EntityHandle handle;
+	unsigned char type, route;
+	float distance, end /* retires when it gets here */, speed;
+	vec3 offset; // place in the stream of aircraft on the same route
+};
+
+// ========================================
+
+/** AI aircraft on the arrival, departure and holding patterns, they have no objects, so thousands of them are cheap. */
+class Traffic
+{
+	private:
+
+		EntityStore *store;
+		SplinePath *routes[ROUTES_COUNT];
+		size_t target;
+		unsigned int seed;
+
+		vector <Aircraft> aircraft; // retired ones are swapped with the last one
+		PathBatch batch;
+
+		float random();
+		void spawn(bool anywhere);
+		void retire(size_t i);
+		void move(size_t begin, size_t end);
+
+	public:
+
+		Traffic(EntityStore *store, SplinePath *arrival, SplinePath *departure, SplinePath *holding, size_t target, unsigned int seed);
+		~Traffic();
+
+		// ****************************************
+
+		size_t getTarget();
+		void setTarget(size_t target);
+
+		size_t getCount();
+
+		// ****************************************
+
+		void update(float step, JobSystem *jobs);
+		void collect(vector <unsigned int> instances[TRAFFIC_TYPES_COUNT]);
+};
+
+float getTrafficSize(int type);
+vec3 getTrafficAngle(int type, vec3 dir);
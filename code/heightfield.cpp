@@ -0,0 +1,251 @@
+#include "headers/bvh.h"
+#include "headers/data.h"
+#include "headers/heightfield.h"
+
+// ========================================
+
+Heightfield::Heightfield(vec2 min, vec2 max, float cellSize)
+{
+	this->origin = min;
+	this->cellSize = cellSize;
+
+	this->cols = std::max((int)ceil((max.x - min.x) / cellSize), 1) + 1;
+	this->rows = std::max((int)ceil((max.y - min.y) / cellSize), 1) + 1;
+
+	this->heights.assign(this->cols * this->rows, 0.0f);
+	this->buildPyramid();
+} // CONSTRUCTOR
+
+// ========================================
+
+float Heightfield::getCellSize()  {return this->cellSize;}
+int   Heightfield::getCols()      {return this->cols;}
+int   Heightfield::getRows()      {return this->rows;}
+float Heightfield::getMinHeight() {return this->pyramid.back()[0].x;}
+float Heightfield::getMaxHeight() {return this->pyramid.back()[0].y;}
+
+// ========================================
+
+float Heightfield::getSample(int x, int z)
+{
+	x = clamp(x, 0, this->cols - 1);
+	z = clamp(z, 0, this->rows - 1);
+
+	return this->heights[z * this->cols + x];
+} // GET SAMPLE
+
+// ========================================
+
+/** Stores min and max heights of cells and merges them by 2x2 up to a single node. */
+void Heightfield::buildPyramid()
+{
+	this->pyramid.clear();
+	this->levelCols.clear();
+	this->levelRows.clear();
+
+	// single cells
+	int w = this->cols - 1, h = this->rows - 1;
+	vector <vec2> level(w * h);
+	for (int z = 0; z < h; z++)
+		for (int x = 0; x < w; x++)
+		{
+			float h00 = this->getSample(x, z), h10 = this->getSample(x + 1, z);
+			float h01 = this->getSample(x, z + 1), h11 = this->getSample(x + 1, z + 1);
+			level[z * w + x] = vec2(glm::min(glm::min(h00, h10), glm::min(h01, h11)), glm::max(glm::max(h00, h10), glm::max(h01, h11)));
+		} // for
+
+	this->pyramid.push_back(level);
+	this->levelCols.push_back(w);
+	this->levelRows.push_back(h);
+
+	// coarser levels
+	while ((w > 1) || (h > 1))
+	{
+		int pw = w, ph = h;
+		w = (w + 1) / 2;
+		h = (h + 1) / 2;
+
+		const vector <vec2> &prev = this->pyramid.back();
+		vector <vec2> next(w * h, vec2(INFINITY, -INFINITY));
+		for (int z = 0; z < ph; z++)
+			for (int x = 0; x < pw; x++)
+			{
+				vec2 &node = next[(z / 2) * w + x / 2];
+				node.x = glm::min(node.x, prev[z * pw + x].x);
+				node.y = glm::max(node.y, prev[z * pw + x].y);
+			} // for
+
+		this->pyramid.push_back(next);
+		this->levelCols.push_back(w);
+		this->levelRows.push_back(h);
+	} // while
+} // BUILD PYRAMID
+
+// ========================================
+
+/** Casts rays downwards onto the ground objects, places with no hit get the bottom height. */
+void Heightfield::sample(vector <Object*> &ground, float top, float bottom, JobSystem *jobs)
+{
+	vector <mat4> invMMatrices;
+	for (auto it : ground)
+		invMMatrices.push_back((it && it->getBvh()) ? inverse(it->getMMatrix()) : mat4(1.0f));
+
+	// rows are independent, each of them is cast by one worker
+	jobs->parallelFor(this->rows, 8, [&](size_t begin, size_t end)
+	{
+		for (int z = (int)begin; z < (int)end; z++)
+			for (int x = 0; x < this->cols; x++)
+			{
+				vec3 origin = vec3(this->origin.x + x * this->cellSize, top, this->origin.y + z * this->cellSize);
+				float nearest = top - bottom;
+
+				for (size_t i = 0; i < ground.size(); i++)
+				{
+					if (!ground[i] || !ground[i]->getBvh()) continue;
+
+					mat4 &invMMatrix = invMMatrices[i];
+					ground[i]->getBvh()->intersectRay(vec3(invMMatrix * vec4(origin, 1.0f)), vec3(invMMatrix * vec4(-Y_AXIS, 0.0f)), nearest);
+				} // for
+
+				this->heights[z * this->cols + x] = top - nearest;
+			} // for
+	});
+
+	this->buildPyramid();
+} // SAMPLE
+
+// ========================================
+
+/** Returns the height of the ground in constant time (same triangles as the segment test). */
+float Heightfield::getHeight(float x, float z)
+{
+	float fx = (x - this->origin.x) / this->cellSize;
+	float fz = (z - this->origin.y) / this->cellSize;
+
+	int cx = clamp((int)floor(fx), 0, this->cols - 2);
+	int cz = clamp((int)floor(fz), 0, this->rows - 2);
+
+	fx = clamp(fx - cx, 0.0f, 1.0f);
+	fz = clamp(fz - cz, 0.0f, 1.0f);
+
+	float h00 = this->getSample(cx, cz), h10 = this->getSample(cx + 1, cz);
+	float h01 = this->getSample(cx, cz + 1), h11 = this->getSample(cx + 1, cz + 1);
+
+	if (fx >= fz) // cell is split by its diagonal
+		return h00 + fx * (h10 - h00) + fz * (h11 - h10);
+
+	return h00 + fz * (h01 - h00) + fx * (h11 - h01);
+} // GET HEIGHT
+
+// ========================================
+
+vec3 Heightfield::getNormal(float x, float z)
+{
+	float dx = this->getHeight(x + this->cellSize, z) - this->getHeight(x - this->cellSize, z);
+	float dz = this->getHeight(x, z + this->cellSize) - this->getHeight(x, z - this->cellSize);
+
+	return normalize(vec3(-dx, 2.0f * this->cellSize, -dz));
+} // GET NORMAL
+
+// ========================================
+
+/** Finds the first time (0-1) when the segment goes under the ground. */
+bool Heightfield::intersectSegment(vec3 from, vec3 to, float &t)
+{
+	t = 1.0f;
+	int top = (int)this->pyramid.size() - 1;
+
+	return this->intersectNode(top, 0, 0, from, to - from, t);
+} // INTERSECT SEGMENT
+
+// ========================================
+
+/** Skips whole nodes whose maximal height is under the segment. */
+bool Heightfield::intersectNode(int level, int x, int z, vec3 from, vec3 move, float &t)
+{
+	// area of the node on the ground
+	int span = 1 << level;
+	float x0 = this->origin.x + x * span * this->cellSize;
+	float z0 = this->origin.y + z * span * this->cellSize;
+	float x1 = this->origin.x + std::min((x + 1) * span, this->cols - 1) * this->cellSize;
+	float z1 = this->origin.y + std::min((z + 1) * span, this->rows - 1) * this->cellSize;
+
+	// part of the segment above the node
+	float tEnter = 0.0f, tExit = t;
+	float lower[2] = {x0, z0}, upper[2] = {x1, z1};
+	float start[2] = {from.x, from.z}, step[2] = {move.x, move.z};
+
+	for (int i = 0; i < 2; i++)
+	{
+		if (abs(step[i]) < 1e-8f)
+		{
+			if ((start[i] < lower[i]) || (start[i] > upper[i])) return false;
+			continue;
+		} // if
+
+		float t1 = (lower[i] - start[i]) / step[i];
+		float t2 = (upper[i] - start[i]) / step[i];
+		tEnter = std::max(tEnter, std::min(t1, t2));
+		tExit = std::min(tExit, std::max(t1, t2));
+	} // for
+
+	if (tEnter > tExit) return false;
+
+	float yMin = std::min(from.y + tEnter * move.y, from.y + tExit * move.y);
+	if (yMin > this->pyramid[level][z * this->levelCols[level] + x].y) return false; // segment is above everything
+
+	if (level == 0)
+		return this->intersectCell(x, z, from, move, t);
+
+	// ****************************************
+
+	bool hit = false;
+	for (int cz = 2 * z; cz <= 2 * z + 1; cz++)
+		for (int cx = 2 * x; cx <= 2 * x + 1; cx++)
+			if ((cx < this->levelCols[level - 1]) && (cz < this->levelRows[level - 1]))
+				hit |= this->intersectNode(level - 1, cx, cz, from, move, t);
+
+	return hit;
+} // INTERSECT NODE
+
+// ========================================
+
+/** Intersects the segment with both triangles of the cell. */
+bool Heightfield::intersectCell(int x, int z, vec3 from, vec3 move, float &t)
+{
+	float px = this->origin.x + x * this->cellSize, pz = this->origin.y + z * this->cellSize;
+	vec3 v00 = vec3(px, this->getSample(x, z), pz);
+	vec3 v10 = vec3(px + this->cellSize, this->getSample(x + 1, z), pz);
+	vec3 v01 = vec3(px, this->getSample(x, z + 1), pz + this->cellSize);
+	vec3 v11 = vec3(px + this->cellSize, this->getSample(x + 1, z + 1), pz + this->cellSize);
+
+	vec3 triangles[2][3] = {{v00, v10, v11}, {v00, v11, v01}};
+
+	bool hit = false;
+	for (auto &tri : triangles)
+	{
+		vec3 e1 = tri[1] - tri[0];
+		vec3 e2 = tri[2] - tri[0];
+		vec3 p = cross(move, e2);
+
+		float det = dot(e1, p);
+		if (abs(det) < 1e-8f) continue;
+
+		vec3 s = from - tri[0];
+		float u = dot(s, p) / det;
+		if ((u < 0.0f) || (u > 1.0f)) continue;
+
+		vec3 q = cross(s, e1);
+		float v = dot(move, q) / det;
+		if ((v < 0.0f) || (u + v > 1.0f)) continue;
+
+		float hitT = dot(e2, q) / det;
+		if ((hitT >= 0.0f) && (hitT < t))
+		{
+			t = hitT;
+			hit = true;
+		} // if
+	} // for
+
+	return hit;
+} // INTERSECT CELL
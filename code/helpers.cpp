@@ -1,9 +1,18 @@
 #include "headers/helpers.h"
+#include "headers/profiler.h"
 
 // ========================================
 
-/** Loads external 3D model (.OBJ and .MTL files + textures). */
-void loadModel(const string &filename, GLuint program, vector <Mesh*> &model)
+/** Returns seconds of a monotonic clock, it is shared by the simulation and the renderer. */
+double getWallTime()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+} // GET WALL TIME
+
+// ========================================
+
+/** Loads external 3D model (.OBJ and .MTL files + textures), without a program nothing is sent to the GPU. */
+void loadModel(const string &filename, GLuint program, vector <Mesh*> &model, Bvh *bvh, Job *group)
 {
 	Importer importer; // get loader from Assimp library
 	importer.SetPropertyInteger(AI_CONFIG_PP_PTV_NORMALIZE, 1); // normalize model
@@ -23,6 +32,24 @@ void loadModel(const string &filename, GLuint program, vector <Mesh*> &model)
 	{
 		const aiMesh* mesh = scn->mMeshes[i]; // get mesh
 
+		// store triangle faces
+		unsigned int* indices = new unsigned int[mesh->mNumFaces * 3];
+		for (unsigned int f = 0; f < mesh->mNumFaces; ++f)
+		{
+			indices[f * 3 + 0] = mesh->mFaces[f].mIndices[0];
+			indices[f * 3 + 1] = mesh->mFaces[f].mIndices[1];
+			indices[f * 3 + 2] = mesh->mFaces[f].mIndices[2];
+		} // for
+
+		if (bvh) // keep the same triangles for ray casting
+			bvh->addTriangles((const float*)mesh->mVertices, 3, indices, mesh->mNumFaces);
+
+		if (!program) // headless runs need only the triangles for collisions
+		{
+			delete[] indices;
+			continue;
+		} // if
+
 		Mesh *part = new Mesh();
 		part->setNumTriangles(mesh->mNumFaces);
 
@@ -50,15 +77,6 @@ void loadModel(const string &filename, GLuint program, vector <Mesh*> &model)
 
 		// ****************************************
 
-		// store triangle faces
-		unsigned int* indices = new unsigned int[mesh->mNumFaces * 3];
-		for (unsigned int f = 0; f < mesh->mNumFaces; ++f)
-		{
-			indices[f * 3 + 0] = mesh->mFaces[f].mIndices[0];
-			indices[f * 3 + 1] = mesh->mFaces[f].mIndices[1];
-			indices[f * 3 + 2] = mesh->mFaces[f].mIndices[2];
-		} // for
-
 		// create ebo
 		glGenBuffers(1, part->getAddressEbo());
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, part->getEbo());
@@ -144,10 +162,51 @@ void loadModel(const string &filename, GLuint program, vector <Mesh*> &model)
 
 		model.push_back(part); // insert mesh into the model
 	} // for
+
+	if (bvh && group) // hierarchy over all meshes of the model (on a worker, the group tells when it is done)
+		jobs->spawn([bvh] {bvh->build();}, group);
+	else if (bvh)
+		bvh->build();
 } // CREATE MODEL
 
 // ========================================
 
+/** Blows up the object and removes it from the world. */
+void destroyObject(Object **obj)
+{
+	explosions.push_back(new Explosion((*obj)->getPos(), vec3(0.0f), vec3(2.0f), vec3(0.0f), vec3(0.0f), 0.0f, state->getElapsedTime()));
+	grid->remove(*obj);
+	deleteComponent(obj);
+} // DESTROY OBJECT
+
+// ========================================
+
+/** Ends the game with the crash of the flown plane. */
+void crashPlane(Object *plane)
+{
+	gameOver = new GameOver(cam->getPos() + 0.975f * cam->getDir(), vec3(0.0f), vec3(1.0f), vec3(0.0f), vec3(0.0f), 0.0f, state->getElapsedTime());
+	state->setGameOver(true);
+	flashlightOn = false;
+	planeModeOn = false;
+
+	for (auto it : {&jetPlane, &fighterPlane, &retroPlane}) // the global pointer is cleared too
+		if (*it == plane)
+			destroyObject(it);
+
+	cam->setPlane(nullptr);
+} // CRASH PLANE
+
+// ========================================
+
+/** Returns the lowest height of the object at its position (it stands on its wheels there). */
+float getGroundLevel(Object *obj)
+{
+	float clearance = obj->getDefPos().y - heightfield->getHeight(obj->getDefPos().x, obj->getDefPos().z);
+	return heightfield->getHeight(obj->getPos().x, obj->getPos().z) + clearance;
+} // GET GROUND LEVEL
+
+// ========================================
+
 /** Checks collision with hangar. */
 bool checkComplexCollision(vec3 myPos, vec3 myBoundBox, vec3 objPos, vec3 objBoundBox, vec3 objInBox)
 {
@@ -182,66 +241,157 @@ bool checkTrivialCollision(vec3 myPos, vec3 myBoundBox, vec3 objPos, vec3 objBou
 	if (((x - myBoundBox.x / 2.0f) <= objBoundBox.x) &&
 		  ((y - myBoundBox.y / 2.0f) <= objBoundBox.y) &&
 		  ((z - myBoundBox.z / 2.0f) <= objBoundBox.z)) // collision
+		return true;
+
+	return false;
+} // CHECK TRIVIAL COLLISION
+
+// ========================================
+
+/** Checks the box around the mesh of the mover against the triangles of the object. */
+bool checkMeshCollision(Object *me, Object *obj)
+{
+	Bvh *myBvh = me->getBvh();
+
+	// box of the mover in the model space of the object
+	mat4 toObj = inverse(obj->getMMatrix()) * me->getMMatrix();
+	vec3 center = vec3(toObj * vec4(0.5f * (myBvh->getMin() + myBvh->getMax()), 1.0f));
+	vec3 half = 0.5f * (myBvh->getMax() - myBvh->getMin());
+	mat3 axes = mat3(vec3(toObj[0]) * half.x, vec3(toObj[1]) * half.y, vec3(toObj[2]) * half.z);
+
+	return obj->getBvh()->overlapBox(center, axes);
+} // CHECK MESH COLLISION
+
+// ========================================
+
+/** Chooses the narrow phase for one pair of objects, the mover may be the walking player (nullptr). */
+bool checkObjectCollision(Object *me, vec3 myPos, vec3 myBoundBox, Object *obj)
+{
+	if (me && me->getBvh() && obj->getBvh())
+		return checkMeshCollision(me, obj); // plane against real shape (also enters hangars)
+
+	if (obj->getInBox() != vec3(0.0f))
+		return checkComplexCollision(myPos, myBoundBox, obj->getPos(), obj->getBoundBox(), obj->getInBox()); // hangar
+
+	return checkTrivialCollision(myPos, myBoundBox, obj->getPos(), obj->getBoundBox());
+} // CHECK OBJECT COLLISION
+
+// ========================================
+
+/** Finds the first time (0-1) of the movement when the object touches anything, 1 if the way is free. */
+float sweepCollisions(Object *me, vec3 from, vec3 to)
+{
+	vec3 move = to - from;
+	if (length(move) < 1e-6f) return 1.0f;
+
+	me->setPos(from);
+
+	vec3 myMin, myMax;
+	me->getBounds(myMin, myMax);
+	vec3 myHalf = 0.5f * (myMax - myMin);
+	vec3 myCenter = 0.5f * (myMin + myMax);
+
+	// broad phase over the whole swept box
+	vector <Object*> candidates;
+	grid->query(glm::min(myMin, myMin + move), glm::max(myMax, myMax + move), candidates);
+
+	// samples are closer than the half size of the mover, so nothing thin is skipped
+	float step = std::min(std::min(myHalf.x, myHalf.y), myHalf.z) / length(move);
+	step = clamp(step, 0.01f, 1.0f);
+
+	float first = 1.0f;
+	for (auto it : candidates)
 	{
-		if (cam->getPlane() && ((*cam->getPlane())->getCurrSpeed() >= 0.2f))
+		if (it == me) continue;
+
+		// time of impact of the center with the box expanded by the mover (slab test)
+		vec3 objMin, objMax;
+		it->getBounds(objMin, objMax);
+		objMin -= myHalf;
+		objMax += myHalf;
+
+		float tEnter = 0.0f, tExit = first;
+		for (int i = 0; i < 3; i++)
 		{
-			float time = 0.001f * (float)glutGet(GLUT_ELAPSED_TIME);
-			if (jetPlane && (objPos == jetPlane->getPos()))
+			if (abs(move[i]) < 1e-8f)
 			{
-				explosions.push_back(new Explosion(objPos, vec3(0.0f), vec3(2.0f), vec3(0.0f), vec3(0.0f), 0.0f, time));
-				deleteComponent(&jetPlane);
+				if ((myCenter[i] < objMin[i]) || (myCenter[i] > objMax[i])) tEnter = INFINITY; // never inside this slab
+				continue;
 			} // if
-			else if (fighterPlane && (objPos == fighterPlane->getPos()))
-			{
-				explosions.push_back(new Explosion(objPos, vec3(0.0f), vec3(2.0f), vec3(0.0f), vec3(0.0f), 0.0f, time));
-				deleteComponent(&fighterPlane);
-			} // else if
-			else if (retroPlane && (objPos == retroPlane->getPos()))
-			{
-				explosions.push_back(new Explosion(objPos, vec3(0.0f), vec3(2.0f), vec3(0.0f), vec3(0.0f), 0.0f, time));
-				deleteComponent(&retroPlane);
-			} // else if
-			else if (helicopter && (objPos == helicopter->getPos()))
+
+			float t1 = (objMin[i] - myCenter[i]) / move[i];
+			float t2 = (objMax[i] - myCenter[i]) / move[i];
+			tEnter = std::max(tEnter, std::min(t1, t2));
+			tExit = std::min(tExit, std::max(t1, t2));
+		} // for
+
+		if (tEnter > tExit) continue; // boxes do not meet before the current first hit
+
+		// refine inside the interval with the exact test
+		for (float t = tEnter; ; t = std::min(t + step, tExit)) // exit is always tested too
+		{
+			me->setPos(from + t * move);
+			if (checkObjectCollision(me, from + t * move, me->getBoundBox(), it))
 			{
-				explosions.push_back(new Explosion(objPos, vec3(0.0f), vec3(2.0f), vec3(0.0f), vec3(0.0f), 0.0f, time));
-				deleteComponent(&helicopter);
-			} // else if
-		} // if
+				first = t;
+				break;
+			} // if
 
-		return true;
-	} // if
+			if (t >= tExit) break;
+		} // for
+	} // for
 
-	return false;
-} // CHECK TRIVIAL COLLISION
+	me->setPos(from);
+	return first;
+} // SWEEP COLLISIONS
 
 // ========================================
 
-/** Checks collisions with all objects in the world. */
+/** Checks collisions with all objects near the given position. */
 bool checkCollisions(vec3 myPos, vec3 myBoundBox)
 {
-	// check all bounding boxes
-	if (checkTrivialCollision(myPos, myBoundBox, tower->getPos(), tower->getBoundBox()) || // tower
-		  checkTrivialCollision(myPos, myBoundBox, antenna->getPos(), antenna->getBoundBox()) || // antenna
-		  checkTrivialCollision(myPos, myBoundBox, stones[0]->getPos(), stones[0]->getBoundBox()) || // front stone
-		  checkTrivialCollision(myPos, myBoundBox, stones[1]->getPos(), stones[1]->getBoundBox()) || // back stone
-		  checkComplexCollision(myPos, myBoundBox, hangars[0]->getPos(), hangars[0]->getBoundBox(), vec3(6.0f, 3.0f, 3.0f)) || // front hangar
-		  checkComplexCollision(myPos, myBoundBox, hangars[1]->getPos(), hangars[1]->getBoundBox(), vec3(6.0f, 3.0f, 3.0f)) || // back hangar
-		  (jetPlane && (&jetPlane != cam->getPlane()) && checkTrivialCollision(myPos, myBoundBox, jetPlane->getPos(), jetPlane->getBoundBox())) || // jet plane
-		  (fighterPlane && (&fighterPlane != cam->getPlane()) && checkTrivialCollision(myPos, myBoundBox, fighterPlane->getPos(), fighterPlane->getBoundBox())) || // fighter plane
-		  (retroPlane && (&retroPlane != cam->getPlane()) && checkTrivialCollision(myPos, myBoundBox, retroPlane->getPos(), retroPlane->getBoundBox())) || // retro plane
-		  (helicopter && checkTrivialCollision(myPos, myBoundBox, helicopter->getPos(), helicopter->getBoundBox()))) // helicopter
+	ProfileScope scope("collisions");
+	Object *me = cam->getPlane();
+	bool meshOn = me && me->getBvh();
+
+	vec3 myMin = myPos - myBoundBox / 2.0f, myMax = myPos + myBoundBox / 2.0f;
+	if (meshOn)
+		me->getBounds(myMin, myMax);
+
+	// broad phase gives only objects from the same cells
+	vector <Object*> candidates;
+	grid->query(myMin, myMax, candidates);
+
+	Object *hit = nullptr;
+	for (auto it : candidates)
 	{
-		// too fast plane crashes
-		if (cam->getPlane() && ((*cam->getPlane())->getCurrSpeed() >= 0.2f))
+		if (it == me) continue; // the flown plane
+
+		if (checkObjectCollision(me, myPos, myBoundBox, it))
 		{
-			explosions.push_back(new Explosion((*cam->getPlane())->getPos(), vec3(0.0f), vec3(2.0f), vec3(0.0f), vec3(0.0f), 0.0f, 0.001f * (float)glutGet(GLUT_ELAPSED_TIME)));
-			gameOver = new GameOver(cam->getPos() + 0.975f * cam->getDir(), vec3(0.0f), vec3(1.0f), vec3(0.0f), vec3(0.0f), 0.0f, 0.001f * (float)glutGet(GLUT_ELAPSED_TIME));
-			state->setGameOver(true);
-			flashlightOn = false;
-			planeModeOn = false;
+			hit = it;
+			break;
+		} // if
+	} // for
 
-			deleteComponent(cam->getPlane());
-			cam->setPlane(nullptr);
+	// ****************************************
+
+	if (hit)
+	{
+		// too fast plane crashes
+		if (me && (me->getCurrSpeed() >= 0.2f))
+		{
+			// hit aircraft is destroyed too
+			if (hit == jetPlane)
+				destroyObject(&jetPlane);
+			else if (hit == fighterPlane)
+				destroyObject(&fighterPlane);
+			else if (hit == retroPlane)
+				destroyObject(&retroPlane);
+			else if (hit == helicopter)
+				destroyObject(&helicopter);
+
+			crashPlane(me);
 
 			return false;
 		} // if
@@ -254,11 +404,33 @@ bool checkCollisions(vec3 myPos, vec3 myBoundBox)
 
 // ========================================
 
+/** Checks whether the plane has flown into a slope of the terrain (gentle ground is only landing). */
+bool checkTerrain(Object *obj, vec3 from, vec3 to)
+{
+	// follow the wheels slightly above the ground
+	float clearance = getGroundLevel(obj) - heightfield->getHeight(obj->getPos().x, obj->getPos().z) - 0.01f;
+	vec3 wheels = vec3(0.0f, clearance, 0.0f);
+
+	float t = 1.0f;
+	if (!heightfield->intersectSegment(from - wheels, to - wheels, t)) return false;
+
+	vec3 hit = from + t * (to - from);
+	if ((heightfield->getNormal(hit.x, hit.z).y >= GROUND_NORMAL_MIN) || (obj->getCurrSpeed() < 0.2f))
+		return false;
+
+	crashPlane(obj);
+	return true;
+} // CHECK TERRAIN
+
+// ========================================
+
 /** Checks bounds of the world. */
-bool checkBounds(Object **obj)
+bool checkBounds(Object *obj)
 {
-	// for real camera
-	if (!planeModeOn && ((abs(cam->getPos().x) >= ISLAND_WIDTH) || (abs(cam->getPos().z) >= ISLAND_DEPTH)))
+	// for real camera, player walks only on the land which is not too steep
+	if (!planeModeOn &&
+		  ((heightfield->getHeight(cam->getPos().x, cam->getPos().z) < SEA_LEVEL) ||
+		  (heightfield->getNormal(cam->getPos().x, cam->getPos().z).y < GROUND_NORMAL_MIN)))
 			return true;
 
 	// ****************************************
@@ -267,32 +439,49 @@ bool checkBounds(Object **obj)
 	if (planeModeOn)
 	{
 		// bounds scene width
-		if (abs((*obj)->getPos().x) > SCENE_WIDTH)
-			(*obj)->setPos(vec3(-(*obj)->getPos().x, (*obj)->getPos().y, (*obj)->getPos().z));
+		if (abs(obj->getPos().x) > SCENE_WIDTH)
+			obj->setPos(vec3(-obj->getPos().x, obj->getPos().y, obj->getPos().z));
 
-		// bounds scene height
-		(*obj)->setPos(vec3((*obj)->getPos().x, clamp((*obj)->getPos().y, (*obj)->getDefPos().y, 100.0f), (*obj)->getPos().z));
+		// bounds scene height, plane stands on the terrain
+		float groundLevel = getGroundLevel(obj);
+		obj->setPos(vec3(obj->getPos().x, clamp(obj->getPos().y, groundLevel, 100.0f), obj->getPos().z));
 
 		// bounds scene depth
-		if (abs((*obj)->getPos().z) > SCENE_DEPTH)
-			(*obj)->setPos(vec3((*obj)->getPos().x, (*obj)->getPos().y, -(*obj)->getPos().z));
+		if (abs(obj->getPos().z) > SCENE_DEPTH)
+			obj->setPos(vec3(obj->getPos().x, obj->getPos().y, -obj->getPos().z));
 
-		// plane crashes outside the island with no altitude
-		if (((abs((*obj)->getPos().x) >= (ISLAND_WIDTH + 3)) || (abs((*obj)->getPos().z) >= (ISLAND_DEPTH + 3))) &&
-			  ((*obj)->getPos().y == (*obj)->getDefPos().y))
+		// plane crashes on the sea with no altitude
+		groundLevel = getGroundLevel(obj);
+		if ((heightfield->getHeight(obj->getPos().x, obj->getPos().z) < SEA_LEVEL) && (obj->getPos().y <= groundLevel))
 		{
-			explosions.push_back(new Explosion((*obj)->getPos(), vec3(0.0f), vec3(2.0f), vec3(0.0f), vec3(0.0f), 0.0f, 0.001f * (float)glutGet(GLUT_ELAPSED_TIME)));
-			gameOver = new GameOver(cam->getPos() + 0.975f * cam->getDir(), vec3(0.0f), vec3(1.0f), vec3(0.0f), vec3(0.0f), 0.0f, 0.001f * (float)glutGet(GLUT_ELAPSED_TIME));
-			state->setGameOver(true);
-			flashlightOn = false;
-			planeModeOn = false;
-
-			deleteComponent(obj);
-			cam->setPlane(nullptr);
-
+			crashPlane(obj);
 			return true;
 		} // if
 	} // if
 
 	return false;
 } // CHECK BOUNDS
+
+// ========================================
+
+/** Finds the nearest object hit by the ray and returns its id (0 for nothing or an object without id). */
+unsigned int castRay(vector <Object*> &objects, vec3 origin, vec3 dir)
+{
+	float nearest = INFINITY;
+	unsigned int hitID = 0;
+
+	for (auto it : objects)
+	{
+		if (!it || !it->getBvh()) continue;
+
+		// cast the ray in the model space, the distance stays the same along the transformed ray
+		mat4 invMMatrix = inverse(it->getMMatrix());
+		vec3 modelOrigin = vec3(invMMatrix * vec4(origin, 1.0f));
+		vec3 modelDir = vec3(invMMatrix * vec4(dir, 0.0f));
+
+		if (it->getBvh()->intersectRay(modelOrigin, modelDir, nearest))
+			hitID = it->getId(); // scenery occludes objects behind it with id 0
+	} // for
+
+	return hitID;
+} // CAST RAY
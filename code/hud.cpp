@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+#include "headers/hud.h"
+#include "headers/data.h"
+#include "headers/helpers.h"
+
+#ifndef GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX
+#define GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX 0x9048
+#define GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX 0x9049
+#endif
+
+static const int PIXEL = 2; // screen pixels per pixel of the font
+static const float MARGIN = 10.0f;
+static const float LINE = 7.0f * PIXEL;
+static const float GRAPH_HEIGHT = 60.0f;
+static const float GRAPH_MAX_TIME = 50.0f; // ms at the top of the graph
+
+// 3x5 font, rows from the top, bit 4 is the left column
+static const char GLYPH_CHARS[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.:/-";
+static const unsigned char glyphs[][5] =
+{
+	{7, 5, 5, 5, 7}, {2, 6, 2, 2, 7}, {7, 1, 7, 4, 7}, {7, 1, 7, 1, 7}, {5, 5, 7, 1, 1},
+	{7, 4, 7, 1, 7}, {7, 4, 7, 5, 7}, {7, 1, 1, 1, 1}, {7, 5, 7, 5, 7}, {7, 5, 7, 1, 7},
+	{2, 5, 7, 5, 5}, {6, 5, 6, 5, 6}, {3, 4, 4, 4, 3}, {6, 5, 5, 5, 6}, {7, 4, 6, 4, 7},
+	{7, 4, 6, 4, 4}, {3, 4, 5, 5, 3}, {5, 5, 7, 5, 5}, {7, 2, 2, 2, 7}, {1, 1, 1, 5, 2},
+	{5, 5, 6, 5, 5}, {4, 4, 4, 4, 7}, {5, 7, 7, 5, 5}, {6, 5, 5, 5, 5}, {2, 5, 5, 5, 2},
+	{6, 5, 6, 4, 4}, {2, 5, 5, 6, 3}, {6, 5, 6, 5, 5}, {3, 4, 2, 1, 6}, {7, 2, 2, 2, 2},
+	{5, 5, 5, 5, 7}, {5, 5, 5, 5, 2}, {5, 5, 7, 7, 5}, {5, 5, 2, 5, 5}, {5, 5, 2, 2, 2},
+	{7, 1, 2, 4, 7}, {0, 0, 0, 0, 2}, {0, 2, 0, 2, 0}, {1, 1, 2, 4, 4}, {0, 0, 7, 0, 0}
+};
+
+// ========================================
+
+void RenderStats::clear()
+{
+	this->drawCalls = this->triangles = this->stateChanges = this->uniforms = this->textureBinds = 0;
+} // CLEAR
+
+// ========================================
+
+void RenderStats::addProgram(unsigned int uniforms)
+{
+	this->stateChanges++;
+	this->uniforms += uniforms;
+} // ADD PROGRAM
+
+// ========================================
+
+void RenderStats::addTexture()
+{
+	this->textureBinds++;
+	this->uniforms++;
+} // ADD TEXTURE
+
+// ========================================
+
+/** Counts the triangles from the vertices the same way as the GPU assembles them. */
+void RenderStats::addDraw(GLenum mode, GLsizei count, GLsizei instances)
+{
+	GLsizei triangles = (mode == GL_TRIANGLE_STRIP) ? std::max(count - 2, 0) : count / 3;
+
+	this->drawCalls++;
+	this->stateChanges++; // vertex array
+	this->triangles += (unsigned int)(triangles * instances);
+} // ADD DRAW
+
+// ========================================
+
+Hud::Hud(GLuint program)
+{
+	this->program = program;
+	this->capacity = 0;
+	this->next = 0;
+	this->lastTime = getWallTime();
+
+	for (int i = 0; i < GRAPH_FRAMES; i++)
+		this->frameTimes[i] = 0.0f;
+
+	// unknown enum only raises an error, so the query itself tells whether the extension is there
+	for (int i = 0; (i < 8) && (glGetError() != GL_NO_ERROR); i++); // older errors, a lost context would report one forever
+	GLint total = 0;
+	glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &total);
+	this->gpuMemoryOn = (glGetError() == GL_NO_ERROR) && (total > 0);
+
+	// ****************************************
+
+	glGenVertexArrays(1, &this->vao);
+	glBindVertexArray(this->vao);
+
+	glGenBuffers(1, &this->buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, this->buffer);
+
+	// transfer positions to vertex shader
+	GLint posLoc = glGetAttribLocation(program, VERT_POS_VAR);
+	glEnableVertexAttribArray(posLoc);
+	glVertexAttribPointer(posLoc, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
+
+	// transfer colors to vertex shader
+	GLint colLoc = glGetAttribLocation(program, VERT_COL_VAR);
+	glEnableVertexAttribArray(colLoc);
+	glVertexAttribPointer(colLoc, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(2 * sizeof(float)));
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+} // CONSTRUCTOR
+
+// ========================================
+
+Hud::~Hud()
+{
+	glDeleteBuffers(1, &this->buffer);
+	glDeleteVertexArrays(1, &this->vao);
+} // DESTRUCTOR
+
+// ========================================
+
+/** Returns the frame rate averaged over the graph (frames measured so far only). */
+float Hud::getFps()
+{
+	float sum = 0.0f;
+	int count = 0;
+
+	for (int i = 0; i < GRAPH_FRAMES; i++)
+		if (this->frameTimes[i] > 0.0f)
+		{
+			sum += this->frameTimes[i];
+			count++;
+		} // if
+
+	return (sum > 0.0f) ? 1000.0f * count / sum : 0.0f;
+} // GET FPS
+
+// ========================================
+
+/** Returns MB of video memory in use or a negative number when the driver does not tell. */
+float Hud::getGpuMemory()
+{
+	if (!this->gpuMemoryOn) return -1.0f;
+
+	GLint total = 0, available = 0; // kB
+	glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &total);
+	glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available);
+
+	return (total - available) / 1024.0f;
+} // GET GPU MEMORY
+
+// ========================================
+
+/** Measures the time since the last frame, it is called every frame (also while hidden) to keep the graph going. */
+void Hud::update()
+{
+	double time = getWallTime();
+
+	this->frameTimes[this->next] = (float)(1000.0 * (time - this->lastTime));
+	this->next = (this->next + 1) % GRAPH_FRAMES;
+	this->lastTime = time;
+} // UPDATE
+
+// ========================================
+
+void Hud::addQuad(float x, float y, float w, float h, vec4 color)
+{
+	const float corners[6][2] = {{x, y}, {x, y + h}, {x + w, y + h}, {x, y}, {x + w, y + h}, {x + w, y}};
+
+	for (auto &it : corners)
+		this->vertices.push_back({it[0], it[1], color.x, color.y, color.z, color.w});
+} // ADD QUAD
+
+// ========================================
+
+/** Adds every lit pixel of the text as a quad, unknown characters stay empty. */
+void Hud::addText(const string &text, float x, float y, vec4 color)
+{
+	for (char c : text)
+	{
+		const char *found = (c != '\0') ? strchr(GLYPH_CHARS, toupper((unsigned char)c)) : nullptr;
+
+		if (found)
+		{
+			const unsigned char *rows = glyphs[found - GLYPH_CHARS];
+
+			for (int row = 0; row < 5; row++)
+				for (int col = 0; col < 3; col++)
+					if (rows[row] & (4 >> col))
+						this->addQuad(x + col * PIXEL, y + row * PIXEL, (float)PIXEL, (float)PIXEL, color);
+		} // if
+
+		x += 4 * PIXEL;
+	} // for
+} // ADD TEXT
+
+// ========================================
+
+/** Builds the whole overlay on the CPU and draws it with one call over the picture. */
+void Hud::draw(const RenderStats &stats, float simTime, int winW, int winH)
+{
+	this->vertices.clear();
+
+	const vec4 textColor = vec4(1.0f);
+	const float width = GRAPH_FRAMES * 2.0f;
+	float last = this->frameTimes[(this->next + GRAPH_FRAMES - 1) % GRAPH_FRAMES];
+	float gpuMemory = this->getGpuMemory();
+
+	char lines[9][64];
+	snprintf(lines[0], sizeof(lines[0]), "FPS %.1f", this->getFps());
+	snprintf(lines[1], sizeof(lines[1]), "FRAME %.2f MS", last);
+	snprintf(lines[2], sizeof(lines[2]), "DRAWS %u", stats.drawCalls);
+	snprintf(lines[3], sizeof(lines[3]), "TRIANGLES %u", stats.triangles);
+	snprintf(lines[4], sizeof(lines[4]), "STATES %u", stats.stateChanges);
+	snprintf(lines[5], sizeof(lines[5]), "UNIFORMS %u", stats.uniforms);
+	snprintf(lines[6], sizeof(lines[6]), "TEXTURES %u", stats.textureBinds);
+	if (gpuMemory >= 0.0f)
+		snprintf(lines[7], sizeof(lines[7]), "GPU MEM %.0f MB", gpuMemory);
+	else
+		snprintf(lines[7], sizeof(lines[7]), "GPU MEM N/A");
+	snprintf(lines[8], sizeof(lines[8]), "SIM TICK %.2f MS", simTime);
+
+	// ****************************************
+
+	// background under the text and the graph
+	float height = 9 * LINE + GRAPH_HEIGHT + MARGIN;
+	this->addQuad(MARGIN - 4.0f, MARGIN - 4.0f, width + 8.0f, height + 8.0f, vec4(0.0f, 0.0f, 0.0f, 0.6f));
+
+	for (int i = 0; i < 9; i++)
+		this->addText(lines[i], MARGIN, MARGIN + i * LINE, textColor);
+
+	// frame time graph from the oldest frame, green within 60 fps, yellow within 30 fps
+	float bottom = MARGIN + height;
+	for (int i = 0; i < GRAPH_FRAMES; i++)
+	{
+		float ms = this->frameTimes[(this->next + i) % GRAPH_FRAMES];
+		float barHeight = std::min(ms / GRAPH_MAX_TIME, 1.0f) * GRAPH_HEIGHT;
+		vec4 color = (ms <= 1000.0f / 60.0f) ? vec4(0.2f, 0.9f, 0.2f, 1.0f) : (ms <= 1000.0f / 30.0f) ? vec4(0.9f, 0.9f, 0.2f, 1.0f) : vec4(0.9f, 0.2f, 0.2f, 1.0f);
+
+		this->addQuad(MARGIN + 2.0f * i, bottom - barHeight, 2.0f, barHeight, color);
+	} // for
+
+	// lines at 60 and 30 fps
+	for (float ms : {1000.0f / 60.0f, 1000.0f / 30.0f})
+		this->addQuad(MARGIN, bottom - ms / GRAPH_MAX_TIME * GRAPH_HEIGHT, width, 1.0f, vec4(1.0f, 1.0f, 1.0f, 0.5f));
+
+	// ****************************************
+
+	// stream the vertices, the buffer only grows
+	if (this->vertices.size() > this->capacity)
+		this->capacity = 2 * this->vertices.size();
+
+	glBindBuffer(GL_ARRAY_BUFFER, this->buffer);
+	glBufferData(GL_ARRAY_BUFFER, this->capacity * sizeof(Vertex), nullptr, GL_STREAM_DRAW); // orphan the storage of the last frame
+	glBufferSubData(GL_ARRAY_BUFFER, 0, this->vertices.size() * sizeof(Vertex), this->vertices.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// ****************************************
+
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glUseProgram(this->program);
+
+	// send data to vertex shader
+	glUniform2fv(glGetUniformLocation(this->program, SCREEN_VAR), 1, value_ptr(vec2((float)winW, (float)winH)));
+
+	// draw vertices
+	glBindVertexArray(this->vao);
+	glDrawArrays(GL_TRIANGLES, 0, (GLsizei)this->vertices.size());
+	glBindVertexArray(0);
+
+	glUseProgram(0);
+	glDisable(GL_BLEND);
+	glEnable(GL_DEPTH_TEST);
+} // DRAW
@@ -0,0 +1,208 @@
+#include "pgr.h"
+#include "headers/impostor.h"
+#include "headers/object.h"
+#include "headers/data.h"
+#include "headers/hud.h"
+
+using namespace pgr;
+
+// ========================================
+
+/** Maps a unit vector onto the octahedron unfolded into a square <0, 1> x <0, 1>. */
+static vec2 encodeOctahedron(vec3 dir)
+{
+	dir /= abs(dir.x) + abs(dir.y) + abs(dir.z);
+
+	vec2 result = vec2(dir.x, dir.z);
+	if (dir.y < 0.0f) // fold the lower half over the diagonals
+		result = vec2
+		(
+			(1.0f - abs(result.y)) * (result.x >= 0.0f ? 1.0f : -1.0f),
+			(1.0f - abs(result.x)) * (result.y >= 0.0f ? 1.0f : -1.0f)
+		);
+
+	return 0.5f * result + vec2(0.5f);
+} // ENCODE OCTAHEDRON
+
+// ========================================
+
+/** Maps a point of the unfolded octahedron back onto a unit vector. */
+static vec3 decodeOctahedron(vec2 coords)
+{
+	vec2 p = 2.0f * coords - vec2(1.0f);
+	vec3 result = vec3(p.x, 1.0f - abs(p.x) - abs(p.y), p.y);
+
+	if (result.y < 0.0f) // unfold the lower half
+		result = vec3
+		(
+			(1.0f - abs(p.y)) * (p.x >= 0.0f ? 1.0f : -1.0f),
+			result.y,
+			(1.0f - abs(p.x)) * (p.y >= 0.0f ? 1.0f : -1.0f)
+		);
+
+	return normalize(result);
+} // DECODE OCTAHEDRON
+
+// ========================================
+
+Impostor::Impostor(GLuint program, int frames, int resolution)
+{
+	this->program = program;
+	this->frames = frames;
+	this->resolution = resolution;
+
+	this->quad = new Mesh();
+	this->quad->createImpostorMesh(program);
+
+	// create atlas of views
+	glGenTextures(1, &this->texture);
+	glBindTexture(GL_TEXTURE_2D, this->texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, frames * resolution, frames * resolution, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	// create depth for baking
+	glGenRenderbuffers(1, &this->depth);
+	glBindRenderbuffer(GL_RENDERBUFFER, this->depth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, frames * resolution, frames * resolution);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	// connect everything to frame buffer
+	glGenFramebuffers(1, &this->fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, this->fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->texture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->depth);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		dieWithError("Error while creating IMPOSTOR frame buffer.");
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+} // CONSTRUCTOR
+
+// ========================================
+
+Impostor::~Impostor()
+{
+	glDeleteFramebuffers(1, &this->fbo);
+	glDeleteRenderbuffers(1, &this->depth);
+	glDeleteTextures(1, &this->texture);
+
+	delete this->quad;
+} // DESTRUCTOR
+
+// ========================================
+
+GLuint Impostor::getProgram()               {return this->program;}
+void   Impostor::setProgram(GLuint program) {this->program = program;}
+
+GLuint Impostor::getTexture()               {return this->texture;}
+
+int    Impostor::getFrames()                {return this->frames;}
+int    Impostor::getResolution()            {return this->resolution;}
+
+// ========================================
+
+/** Renders the model from all directions of the octahedron into the atlas. */
+void Impostor::bake(GLuint program, vector <Mesh*> &model, vec3 sunPos)
+{
+	const float zero[] = {0.0f, 0.0f, 0.0f, 0.0f};
+	const float one = 1.0f;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, this->fbo);
+	glClearBufferfv(GL_COLOR, 0, zero);
+	glClearBufferfv(GL_DEPTH, 0, &one);
+
+	// bake with the sun only
+	glUseProgram(program);
+	glUniform3fv(glGetUniformLocation(program, "lights[0].pos"), 1, value_ptr(sunPos));
+	glUniform3fv(glGetUniformLocation(program, "lights[0].amb"), 1, value_ptr(vec3(0.0f)));
+	glUniform3fv(glGetUniformLocation(program, "lights[0].dif"), 1, value_ptr(vec3(1.0f)));
+	glUniform3fv(glGetUniformLocation(program, "lights[0].spe"), 1, value_ptr(vec3(1.0f)));
+	glUniform1i(glGetUniformLocation(program, DAY_ON_VAR), 1);
+	glUniform1i(glGetUniformLocation(program, FLA_ON_VAR), 0);
+	glUniform1i(glGetUniformLocation(program, MIST_ON_VAR), 0);
+	glUseProgram(0);
+
+	// model space object (models are normalized into <-1, 1>)
+	Object object(vec3(0.0f), vec3(0.0f), vec3(1.0f), vec3(0.0f), vec3(0.0f));
+	mat4 pMatrix = ortho(-IMPOSTOR_RADIUS, IMPOSTOR_RADIUS, -IMPOSTOR_RADIUS, IMPOSTOR_RADIUS, 0.1f, 4.0f * IMPOSTOR_RADIUS);
+
+	for (int i = 0; i < this->frames; i++)
+		for (int j = 0; j < this->frames; j++)
+		{
+			vec3 dir = decodeOctahedron((vec2((float)i, (float)j) + vec2(0.5f)) / (float)this->frames);
+			vec3 up = (abs(dir.y) > 0.99f) ? Z_AXIS : Y_AXIS;
+			mat4 vMatrix = lookAt(2.0f * IMPOSTOR_RADIUS * dir, vec3(0.0f), up);
+
+			glViewport(i * this->resolution, j * this->resolution, this->resolution, this->resolution);
+			object.draw(program, model, pMatrix, vMatrix, mat4(1.0f));
+		} // for
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, WIN_WIDTH, WIN_HEIGHT);
+} // BAKE
+
+// ========================================
+
+/** Finds the camera-facing quad and the view closest to the direction of the camera (face matrix is the inverse view rotation). */
+void Impostor::getView(mat4 mMatrix, vec3 eye, mat4 faceMatrix, mat4 &quadMatrix, vec2 &frame)
+{
+	vec3 pos = vec3(mMatrix[3]);
+
+	// direction of the camera in model space selects the view
+	vec3 dir = normalize(transpose(mat3(mMatrix)) * (eye - pos));
+	vec2 coords = encodeOctahedron(dir);
+	frame = vec2
+	(
+		(float)std::min((int)(coords.x * this->frames), this->frames - 1),
+		(float)std::min((int)(coords.y * this->frames), this->frames - 1)
+	);
+
+	// transform quad
+	quadMatrix = translate(mat4(1.0f), pos);
+	quadMatrix = scale(quadMatrix, vec3(IMPOSTOR_RADIUS * length(vec3(mMatrix[0]))));
+	quadMatrix = quadMatrix * faceMatrix; // impostor now face the camera
+} // GET VIEW
+
+// ========================================
+
+/** Draws the camera-facing quad with the view closest to the direction of the camera. */
+void Impostor::draw(mat4 mMatrix, unsigned int id, float fade, mat4 pMatrix, mat4 vMatrix)
+{
+	// inverse view rotation
+	mat4 impostorRotMat = transpose(mat4(vMatrix[0], vMatrix[1], vMatrix[2], vec4(0.0f, 0.0f, 0.0f, 1.0f)));
+
+	mat4 quadMatrix;
+	vec2 frame;
+	this->getView(mMatrix, vec3(inverse(vMatrix)[3]), impostorRotMat, quadMatrix, frame);
+
+	glUseProgram(this->program);
+
+	// send data to vertex shader
+	glUniformMatrix4fv(glGetUniformLocation(this->program, P_MAT_VAR), 1, GL_FALSE, value_ptr(pMatrix));
+	glUniformMatrix4fv(glGetUniformLocation(this->program, V_MAT_VAR), 1, GL_FALSE, value_ptr(vMatrix));
+	glUniformMatrix4fv(glGetUniformLocation(this->program, M_MAT_VAR), 1, GL_FALSE, value_ptr(quadMatrix));
+	glUniform2fv(glGetUniformLocation(this->program, FRAME_VAR), 1, value_ptr(frame));
+	glUniform1f(glGetUniformLocation(this->program, FRAMES_VAR), (float)this->frames);
+	glUniform1f(glGetUniformLocation(this->program, FADE_VAR), fade);
+	glUniform1ui(glGetUniformLocation(this->program, OBJ_ID_VAR), id);
+	renderStats.addProgram(7);
+
+	// draw texture
+	glUniform1i(glGetUniformLocation(this->program, TEX_SAM_VAR), 0);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, this->texture);
+	renderStats.addTexture();
+
+	// draw vertices
+	glBindVertexArray(this->quad->getVao());
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, this->quad->getNumTriangles());
+	glBindVertexArray(0);
+	renderStats.addDraw(GL_TRIANGLE_STRIP, this->quad->getNumTriangles());
+
+	glBindTexture(GL_TEXTURE_2D, 0); // unbind texture
+	glUseProgram(0);
+} // DRAW
@@ -0,0 +1,213 @@
+#include "pgr.h"
+#include "headers/instancer.h"
+#include "headers/data.h"
+#include "headers/hud.h"
+
+// ========================================
+
+Instancer::Instancer(GLuint modelProgram, GLuint impostorProgram)
+{
+	this->modelProgram = modelProgram;
+	this->impostorProgram = impostorProgram;
+
+	this->quad = new Mesh();
+	this->quad->createImpostorMesh(impostorProgram);
+
+	glGenBuffers(1, &this->buffer);
+} // CONSTRUCTOR
+
+// ========================================
+
+Instancer::~Instancer()
+{
+	glDeleteBuffers(1, &this->buffer);
+	delete this->quad;
+} // DESTRUCTOR
+
+// ========================================
+
+GLuint Instancer::getModelProgram()    {return this->modelProgram;}
+GLuint Instancer::getImpostorProgram() {return this->impostorProgram;}
+vec3   Instancer::getEye()             {return this->eye;}
+
+// ========================================
+
+/** Remembers the view of the frame and extracts the planes of its frustum. */
+void Instancer::begin(mat4 pMatrix, mat4 vMatrix)
+{
+	this->pMatrix = pMatrix;
+	this->vMatrix = vMatrix;
+	this->faceMatrix = transpose(mat4(vMatrix[0], vMatrix[1], vMatrix[2], vec4(0.0f, 0.0f, 0.0f, 1.0f))); // inverse view rotation
+	this->eye = vec3(inverse(vMatrix)[3]);
+
+	mat4 m = pMatrix * vMatrix;
+	vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+		rows[i] = vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+
+	for (int i = 0; i < 3; i++) // left and right, bottom and top, near and far
+	{
+		this->planes[2 * i] = rows[3] + rows[i];
+		this->planes[2 * i + 1] = rows[3] - rows[i];
+	} // for
+
+	for (auto &it : this->planes)
+		it = it / length(vec3(it.x, it.y, it.z));
+} // BEGIN
+
+// ========================================
+
+/** Checks whether the sphere is at least partly inside the frustum of the frame. */
+bool Instancer::isVisible(vec3 pos, float radius)
+{
+	for (auto &it : this->planes)
+		if (it.x * pos.x + it.y * pos.y + it.z * pos.z + it.w < -radius)
+			return false;
+
+	return true;
+} // IS VISIBLE
+
+// ========================================
+
+/** Replaces the content of the stream buffer (frames are stored behind the matrices). */
+void Instancer::upload(const vector <mat4> &matrices, const vector <vec2> *frames)
+{
+	GLsizeiptr matricesSize = matrices.size() * sizeof(mat4);
+	GLsizeiptr framesSize = frames ? frames->size() * sizeof(vec2) : 0;
+
+	glBindBuffer(GL_ARRAY_BUFFER, this->buffer);
+	glBufferData(GL_ARRAY_BUFFER, matricesSize + framesSize, nullptr, GL_STREAM_DRAW); // orphan the last frame's data
+	glBufferSubData(GL_ARRAY_BUFFER, 0, matricesSize, matrices.data());
+	if (frames)
+		glBufferSubData(GL_ARRAY_BUFFER, matricesSize, framesSize, frames->data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+} // UPLOAD
+
+// ========================================
+
+/** Adds the instance attributes to the vertex array, they advance once per instance. */
+void Instancer::bindInstances(GLuint vao, size_t count, bool withFrames)
+{
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, this->buffer);
+
+	for (int i = 0; i < 4; i++) // one attribute per column
+	{
+		glEnableVertexAttribArray(INST_MAT_LOC + i);
+		glVertexAttribPointer(INST_MAT_LOC + i, 4, GL_FLOAT, GL_FALSE, sizeof(mat4), (void*)(i * sizeof(vec4)));
+		glVertexAttribDivisor(INST_MAT_LOC + i, 1);
+	} // for
+
+	if (withFrames)
+	{
+		glEnableVertexAttribArray(INST_FRAME_LOC);
+		glVertexAttribPointer(INST_FRAME_LOC, 2, GL_FLOAT, GL_FALSE, sizeof(vec2), (void*)(count * sizeof(mat4)));
+		glVertexAttribDivisor(INST_FRAME_LOC, 1);
+	} // if
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+} // BIND INSTANCES
+
+// ========================================
+
+/** Leaves the vertex array as it was, meshes of models are shared with ordinary drawing. */
+void Instancer::unbindInstances(bool withFrames)
+{
+	for (int i = 0; i < 4; i++)
+		glDisableVertexAttribArray(INST_MAT_LOC + i);
+
+	if (withFrames)
+		glDisableVertexAttribArray(INST_FRAME_LOC);
+
+	glBindVertexArray(0);
+} // UNBIND INSTANCES
+
+// ========================================
+
+/** Draws all instances of the model, lights and other shared uniforms are sent by the caller. */
+void Instancer::drawModels(vector <Mesh*> &model, const vector <mat4> &instances)
+{
+	if (instances.empty()) return;
+
+	this->upload(instances, nullptr);
+	glUseProgram(this->modelProgram);
+
+	// send data to vertex shader
+	glUniformMatrix4fv(glGetUniformLocation(this->modelProgram, P_MAT_VAR), 1, GL_FALSE, value_ptr(this->pMatrix));
+	glUniformMatrix4fv(glGetUniformLocation(this->modelProgram, V_MAT_VAR), 1, GL_FALSE, value_ptr(this->vMatrix));
+	glUniform1f(glGetUniformLocation(this->modelProgram, FADE_VAR), 0.0f);
+	glUniform1ui(glGetUniformLocation(this->modelProgram, OBJ_ID_VAR), 0); // not pickable
+	renderStats.addProgram(4);
+
+	for (size_t i = 0; i < model.size(); i++)
+	{
+		glUniform3fv(glGetUniformLocation(this->modelProgram, VERT_AMB_VAR), 1, value_ptr(model[i]->getAmbient()));
+		glUniform3fv(glGetUniformLocation(this->modelProgram, VERT_DIF_VAR), 1, value_ptr(model[i]->getDiffuse()));
+		glUniform3fv(glGetUniformLocation(this->modelProgram, VERT_SPE_VAR), 1, value_ptr(model[i]->getSpecular()));
+		glUniform1f(glGetUniformLocation(this->modelProgram, VERT_SHI_VAR), model[i]->getShininess());
+
+		glUniform1i(glGetUniformLocation(this->modelProgram, TEX_ON_VAR), 0);
+		renderStats.uniforms += 5;
+
+		if (model[i]->getTexture() != 0)
+		{
+			// draw texture
+			glUniform1i(glGetUniformLocation(this->modelProgram, TEX_SAM_VAR), 0);
+			glUniform1i(glGetUniformLocation(this->modelProgram, TEX_ON_VAR), 1);
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, model[i]->getTexture());
+			renderStats.uniforms++;
+			renderStats.addTexture();
+		} // if
+
+		// draw vertices of all instances
+		this->bindInstances(model[i]->getVao(), instances.size(), false);
+		glDrawElementsInstanced(GL_TRIANGLES, model[i]->getNumTriangles() * 3, GL_UNSIGNED_INT, nullptr, (GLsizei)instances.size());
+		this->unbindInstances(false);
+		renderStats.addDraw(GL_TRIANGLES, model[i]->getNumTriangles() * 3, (GLsizei)instances.size());
+
+		glBindTexture(GL_TEXTURE_2D, 0); // unbind texture
+	} // for
+
+	glUseProgram(0);
+} // DRAW MODELS
+
+// ========================================
+
+/** Draws the camera-facing quads of all instances, every one with its own view of the atlas. */
+void Instancer::drawImpostors(Impostor *impostor, const vector <mat4> &instances)
+{
+	if (instances.empty()) return;
+
+	this->matrices.resize(instances.size());
+	this->frames.resize(instances.size());
+
+	for (size_t i = 0; i < instances.size(); i++)
+		impostor->getView(instances[i], this->eye, this->faceMatrix, this->matrices[i], this->frames[i]);
+
+	this->upload(this->matrices, &this->frames);
+	glUseProgram(this->impostorProgram);
+
+	// send data to vertex shader
+	glUniformMatrix4fv(glGetUniformLocation(this->impostorProgram, P_MAT_VAR), 1, GL_FALSE, value_ptr(this->pMatrix));
+	glUniformMatrix4fv(glGetUniformLocation(this->impostorProgram, V_MAT_VAR), 1, GL_FALSE, value_ptr(this->vMatrix));
+	glUniform1f(glGetUniformLocation(this->impostorProgram, FRAMES_VAR), (float)impostor->getFrames());
+	glUniform1f(glGetUniformLocation(this->impostorProgram, FADE_VAR), 1.0f);
+	glUniform1ui(glGetUniformLocation(this->impostorProgram, OBJ_ID_VAR), 0);
+	renderStats.addProgram(5);
+
+	// draw texture
+	glUniform1i(glGetUniformLocation(this->impostorProgram, TEX_SAM_VAR), 0);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, impostor->getTexture());
+	renderStats.addTexture();
+
+	// draw vertices of all instances
+	this->bindInstances(this->quad->getVao(), instances.size(), true);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, this->quad->getNumTriangles(), (GLsizei)instances.size());
+	this->unbindInstances(true);
+	renderStats.addDraw(GL_TRIANGLE_STRIP, this->quad->getNumTriangles(), (GLsizei)instances.size());
+
+	glBindTexture(GL_TEXTURE_2D, 0); // unbind texture
+	glUseProgram(0);
+} // DRAW IMPOSTORS
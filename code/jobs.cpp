@@ -0,0 +1,296 @@
+#include <algorithm>
+
+#include "headers/jobs.h"
+
+static thread_local int workerIndex = -1; // queue of the current thread, -1 for threads outside the system
+
+// ========================================
+
+JobSystem::JobSystem(unsigned int numWorkers)
+{
+	if (numWorkers == 0) // one thread is left for the caller
+		numWorkers = std::max(thread::hardware_concurrency(), 2u) - 1;
+
+	this->running = true;
+	this->queued = 0;
+	this->mainThreadId = this_thread::get_id();
+
+	for (unsigned int i = 0; i <= numWorkers; i++)
+		this->queues.push_back(new WorkQueue());
+
+	for (unsigned int i = 0; i < numWorkers; i++)
+		this->workers.push_back(thread(&JobSystem::workerLoop, this, (int)i));
+} // CONSTRUCTOR
+
+// ========================================
+
+JobSystem::~JobSystem()
+{
+	this->running = false;
+	this->wakeUp.notify_all();
+
+	for (auto &it : this->workers)
+		it.join();
+
+	for (auto it : this->queues)
+		delete it;
+} // DESTRUCTOR
+
+// ========================================
+
+int  JobSystem::getNumWorkers() {return (int)this->workers.size();}
+bool JobSystem::isMainThread()  {return this_thread::get_id() == this->mainThreadId;}
+
+// ========================================
+
+void JobSystem::workerLoop(int index)
+{
+	workerIndex = index;
+
+	while (this->running)
+	{
+		Job *job = this->pop(index);
+		if (job)
+		{
+			this->execute(job);
+			continue;
+		} // if
+
+		// nothing to do or steal, sleep until a job comes (timeout covers a missed notification)
+		unique_lock <mutex> lock(this->sleepLock);
+		this->wakeUp.wait_for(lock, chrono::milliseconds(1), [this] {return (this->queued > 0) || !this->running;});
+	} // while
+} // WORKER LOOP
+
+// ========================================
+
+/** Puts the job into the queue of the current thread (or of the main thread). */
+void JobSystem::push(Job *job)
+{
+	if (job->mainThread)
+	{
+		lock_guard <mutex> lock(this->mainQueue.lock);
+		this->mainQueue.jobs.push_back(job);
+		return;
+	} // if
+
+	WorkQueue *queue = (workerIndex >= 0) ? this->queues[workerIndex] : this->queues.back();
+	{
+		lock_guard <mutex> lock(queue->lock);
+		queue->jobs.push_back(job);
+	}
+
+	this->queued++;
+	this->wakeUp.notify_one();
+} // PUSH
+
+// ========================================
+
+/** Takes the newest own job, otherwise steals the oldest one of another queue. */
+Job* JobSystem::pop(int index)
+{
+	int count = (int)this->queues.size();
+	WorkQueue *own = this->queues[(index >= 0) ? index : count - 1];
+
+	{
+		lock_guard <mutex> lock(own->lock);
+		if (!own->jobs.empty())
+		{
+			Job *job = own->jobs.back();
+			own->jobs.pop_back();
+			this->queued--;
+			return job;
+		} // if
+	}
+
+	for (int i = 1; i < count; i++)
+	{
+		WorkQueue *victim = this->queues[(index + count + i) % count];
+
+		lock_guard <mutex> lock(victim->lock);
+		if (!victim->jobs.empty())
+		{
+			Job *job = victim->jobs.front();
+			victim->jobs.pop_front();
+			this->queued--;
+			return job;
+		} // if
+	} // for
+
+	return nullptr;
+} // POP
+
+// ========================================
+
+void JobSystem::execute(Job *job)
+{
+	if (job->task)
+		job->task();
+
+	this->finish(job);
+} // EXECUTE
+
+// ========================================
+
+/** Counts the job down, the last one releases its dependents and its parent. */
+void JobSystem::finish(Job *job)
+{
+	if (--job->unfinished > 0) return; // children are still running
+
+	// ****************************************
+
+	vector <Job*> dependents;
+	{
+		lock_guard <mutex> lock(job->depMutex);
+		job->released = true;
+		dependents.swap(job->dependents);
+	}
+
+	for (auto it : dependents)
+		if (--it->pendingDeps == 0)
+			this->push(it);
+
+	Job *parent = job->parent;
+
+	// nobody may touch the job after it is marked as done
+	if (job->autoDelete)
+		delete job;
+	else
+		job->done = true;
+
+	if (parent)
+		this->finish(parent);
+} // FINISH
+
+// ========================================
+
+/** Creates the job, it does not start before run is called (dependencies may be added meanwhile). */
+Job* JobSystem::create(function <void()> task, Job *parent, bool mainThread)
+{
+	Job *job = new Job();
+	job->task = task;
+	job->parent = parent;
+	job->mainThread = mainThread;
+	job->autoDelete = false;
+	job->unfinished = 1;
+	job->pendingDeps = 1; // held until run
+	job->released = false;
+	job->done = false;
+
+	if (parent)
+		parent->unfinished++;
+
+	return job;
+} // CREATE
+
+// ========================================
+
+/** Lets the job start only after the other one is finished. */
+void JobSystem::addDependency(Job *job, Job *dependsOn)
+{
+	lock_guard <mutex> lock(dependsOn->depMutex);
+	if (dependsOn->released) return; // already finished
+
+	job->pendingDeps++;
+	dependsOn->dependents.push_back(job);
+} // ADD DEPENDENCY
+
+// ========================================
+
+void JobSystem::run(Job *job)
+{
+	if (--job->pendingDeps == 0)
+		this->push(job);
+} // RUN
+
+// ========================================
+
+/** Starts the task as a child of the parent, only the parent is waited for, so the child deletes itself. */
+void JobSystem::spawn(function <void()> task, Job *parent)
+{
+	Job *child = this->create(task, parent);
+	child->autoDelete = true;
+	this->run(child);
+} // SPAWN
+
+// ========================================
+
+/** Helps with other jobs until the job is finished, then deletes it. */
+void JobSystem::wait(Job *job)
+{
+	while (!job->done)
+	{
+		if (this->isMainThread())
+			this->runMainJobs();
+
+		Job *other = this->pop(workerIndex);
+		if (other)
+			this->execute(other);
+		else
+			this_thread::yield();
+	} // while
+
+	delete job;
+} // WAIT
+
+// ========================================
+
+/** Splits the range into chunks of the given size and waits for all of them. */
+void JobSystem::parallelFor(size_t count, size_t grain, function <void(size_t, size_t)> task)
+{
+	if (count == 0) return;
+	grain = std::max(grain, (size_t)1);
+
+	if (count <= grain) // not worth splitting
+	{
+		task(0, count);
+		return;
+	} // if
+
+	// ****************************************
+
+	Job *root = this->create(nullptr);
+
+	for (size_t begin = 0; begin < count; begin += grain)
+	{
+		size_t end = std::min(begin + grain, count);
+
+		this->spawn([task, begin, end] {task(begin, end);}, root);
+	} // for
+
+	this->run(root);
+	this->wait(root);
+} // PARALLEL FOR
+
+// ========================================
+
+/** Queues the task for the main thread, it runs in the next frame or while the main thread waits. */
+void JobSystem::runOnMainThread(function <void()> task)
+{
+	Job *job = this->create(task, nullptr, true);
+	job->autoDelete = true;
+	this->run(job);
+} // RUN ON MAIN THREAD
+
+// ========================================
+
+void JobSystem::runMainJobs()
+{
+	if (!this->isMainThread()) return;
+
+	// ****************************************
+
+	while (true)
+	{
+		Job *job = nullptr;
+		{
+			lock_guard <mutex> lock(this->mainQueue.lock);
+			if (this->mainQueue.jobs.empty()) break;
+
+			job = this->mainQueue.jobs.front();
+			this->mainQueue.jobs.pop_front();
+		}
+
+		this->execute(job);
+	} // while
+} // RUN MAIN JOBS
@@ -0,0 +1,186 @@
+#include <cstdio>
+#include <cstring>
+
+#include "headers/journal.h"
+
+static const char JOURNAL_MAGIC[4] = {'A', 'P', 'I', 'J'};
+
+// ========================================
+
+InputJournal::InputJournal(unsigned int trafficSeed, unsigned int schedulerSeed)
+{
+	this->replayed = 0;
+	this->steps = 0;
+	this->trafficSeed = trafficSeed;
+	this->schedulerSeed = schedulerSeed;
+	this->replaying = false;
+} // CONSTRUCTOR
+
+// ========================================
+
+InputJournal::InputJournal() : InputJournal(0, 0)
+{
+	this->replaying = true;
+} // CONSTRUCTOR
+
+// ========================================
+
+bool         InputJournal::isReplaying()      {return this->replaying;}
+unsigned int InputJournal::getSteps()         {return this->steps;}
+unsigned int InputJournal::getTrafficSeed()   {return this->trafficSeed;}
+unsigned int InputJournal::getSchedulerSeed() {return this->schedulerSeed;}
+
+// ========================================
+
+void InputJournal::record(unsigned int step, const InputEvent &event)
+{
+	if (!this->replaying)
+		this->entries.push_back({step, event});
+} // RECORD
+
+// ========================================
+
+/** Returns the next event due before the step, false when there is none (yet). */
+bool InputJournal::next(unsigned int step, InputEvent &event)
+{
+	if ((this->replayed >= this->entries.size()) || (this->entries[this->replayed].step > step)) return false;
+
+	event = this->entries[this->replayed++].event;
+	return true;
+} // NEXT
+
+// ========================================
+
+/** Writes only what each type of event needs, steps are stored as differences. */
+bool InputJournal::save(const string &filename, unsigned int steps)
+{
+	FILE *file = fopen(filename.c_str(), "wb");
+	if (!file) return false;
+
+	unsigned int header[5] = {VERSION, steps, this->trafficSeed, this->schedulerSeed, (unsigned int)this->entries.size()};
+	fwrite(JOURNAL_MAGIC, 1, 4, file);
+	fwrite(header, sizeof(unsigned int), 5, file);
+
+	unsigned int last = 0;
+	for (auto &it : this->entries)
+	{
+		// difference of steps in 7-bit groups, most of them fit into one byte
+		unsigned int delta = it.step - last;
+		last = it.step;
+
+		do
+		{
+			unsigned char group = (delta & 0x7F) | ((delta > 0x7F) ? 0x80 : 0);
+			fputc(group, file);
+			delta >>= 7;
+		} while (delta);
+
+		// ****************************************
+
+		fputc(it.event.type, file);
+
+		switch (it.event.type)
+		{
+			case INPUT_MOTION:
+			{
+				short shift[2] = {(short)it.event.x, (short)it.event.y};
+				fwrite(shift, sizeof(short), 2, file);
+				break;
+			} // case
+			case INPUT_PICK:
+				fwrite(&it.event.id, sizeof(unsigned int), 1, file);
+				break;
+			case INPUT_RAY:
+				fwrite(&it.event.origin, sizeof(float), 3, file);
+				fwrite(&it.event.dir, sizeof(float), 3, file);
+				break;
+			default: // keys
+			{
+				short key = (short)it.event.key;
+				fwrite(&key, sizeof(short), 1, file);
+				break;
+			} // default
+		} // switch
+	} // for
+
+	return fclose(file) == 0;
+} // SAVE
+
+// ========================================
+
+bool InputJournal::load(const string &filename)
+{
+	FILE *file = fopen(filename.c_str(), "rb");
+	if (!file) return false;
+
+	char magic[4];
+	unsigned int header[5];
+
+	if ((fread(magic, 1, 4, file) != 4) || memcmp(magic, JOURNAL_MAGIC, 4) ||
+		(fread(header, sizeof(unsigned int), 5, file) != 5) || (header[0] != VERSION))
+	{
+		fclose(file);
+		return false;
+	} // if
+
+	this->steps = header[1];
+	this->trafficSeed = header[2];
+	this->schedulerSeed = header[3];
+	this->entries.assign(header[4], Entry());
+	this->replayed = 0;
+	this->replaying = true;
+
+	// ****************************************
+
+	bool ok = true;
+	unsigned int last = 0;
+
+	for (auto &it : this->entries)
+	{
+		unsigned int delta = 0;
+		int group, bits = 0;
+		do
+		{
+			group = fgetc(file);
+			delta |= (unsigned int)(group & 0x7F) << bits;
+			bits += 7;
+		} while ((group != EOF) && (group & 0x80) && (bits < 32));
+
+		last += delta;
+		it.step = last;
+
+		it.event = InputEvent();
+		it.event.type = fgetc(file);
+
+		switch (it.event.type)
+		{
+			case INPUT_MOTION:
+			{
+				short shift[2] = {0, 0};
+				ok &= fread(shift, sizeof(short), 2, file) == 2;
+				it.event.x = shift[0];
+				it.event.y = shift[1];
+				break;
+			} // case
+			case INPUT_PICK:
+				ok &= fread(&it.event.id, sizeof(unsigned int), 1, file) == 1;
+				break;
+			case INPUT_RAY:
+				ok &= fread(&it.event.origin, sizeof(float), 3, file) == 3;
+				ok &= fread(&it.event.dir, sizeof(float), 3, file) == 3;
+				break;
+			default:
+			{
+				short key = 0;
+				ok &= fread(&key, sizeof(short), 1, file) == 1;
+				it.event.key = key;
+				break;
+			} // default
+		} // switch
+
+		if (!ok || (group == EOF)) break;
+	} // for
+
+	fclose(file);
+	return ok;
+} // LOAD
@@ -2,17 +2,38 @@
 // SETUP
 // ========================================
 
+#include <atomic>
 #include <iostream>
+#include <thread>
 
 #include "pgr.h"
+#include "headers/bvh.h"
+#include "headers/cache.h"
 #include "headers/camera.h"
+#include "headers/clock.h"
+#include "headers/culler.h"
 #include "headers/data.h"
+#include "headers/grid.h"
+#include "headers/heightfield.h"
 #include "headers/helpers.h"
+#include "headers/hud.h"
+#include "headers/impostor.h"
+#include "headers/input.h"
+#include "headers/instancer.h"
+#include "headers/jobs.h"
+#include "headers/journal.h"
 #include "headers/light.h"
 #include "headers/mesh.h"
 #include "headers/object.h"
-#include "headers/spline.h"
+#include "headers/offscreen.h"
+#include "headers/path.h"
+#include "headers/picker.h"
+#include "headers/profiler.h"
+#include "headers/scaler.h"
+#include "headers/scheduler.h"
+#include "headers/snapshot.h"
 #include "headers/state.h"
+#include "headers/traffic.h"
 
 using namespace std;
 using namespace glm;
@@ -27,11 +48,48 @@ GLuint mainProg      = 0;
 GLuint skyboxProg    = 0;
 GLuint explosionProg = 0;
 GLuint gameOverProg  = 0;
+GLuint occlusionProg = 0;
+GLuint impostorProg  = 0;
+GLuint upscaleProg   = 0;
+GLuint instancedProg = 0;
+GLuint instImpProg   = 0;
+GLuint hudProg       = 0;
 
 // components
 Camera *cam    = nullptr;
 State  *state  = nullptr;
 Skybox *skybox = nullptr;
+Culler *culler = nullptr;
+Scaler *scaler = nullptr;
+Picker *picker = nullptr;
+
+// AI aircraft and their drawing
+Traffic   *traffic   = nullptr;
+Scheduler *scheduler = nullptr;
+Instancer *instancer = nullptr;
+
+// tasks spread over all cores
+JobSystem *jobs = nullptr;
+
+// hot data of all objects
+EntityStore *entities = nullptr;
+
+// paths flown with constant speed
+SplinePath *helicopterPath = nullptr;
+SplinePath *airportExhPath = nullptr;
+SplinePath *arrivalPath    = nullptr;
+SplinePath *departurePath  = nullptr;
+SplinePath *holdingPath    = nullptr;
+
+// collision broad phase
+SpatialGrid *grid = nullptr;
+
+// terrain of the island
+Heightfield *heightfield = nullptr;
+
+// render targets
+RenderTarget *sceneTarget = nullptr;
+StaticCache  *staticCache = nullptr;
 
 // objects
 vector <Object*> spotLights;
@@ -53,6 +111,30 @@ Object* gameOver     = nullptr;
 // lights
 vector <Light*> lights;
 
+// impostors
+Impostor *hangarImpostor       = nullptr;
+Impostor *stoneImpostor        = nullptr;
+Impostor *towerImpostor        = nullptr;
+Impostor *antennaImpostor      = nullptr;
+Impostor *jetPlaneImpostor     = nullptr;
+Impostor *fighterPlaneImpostor = nullptr;
+Impostor *retroPlaneImpostor   = nullptr;
+Impostor *helicopterImpostor   = nullptr;
+
+// hierarchies for ray casting
+Bvh islandBvh;
+Bvh runwayBvh;
+Bvh hangarBvh;
+Bvh towerBvh;
+Bvh antennaBvh;
+Bvh jetPlaneBvh;
+Bvh fighterPlaneBvh;
+Bvh retroPlaneBvh;
+Bvh helicopterBvh;
+Bvh stoneBvh;
+Bvh lampBvh;
+Bvh spotLightBvh;
+
 // models
 vector <Mesh*> spotLightModel;
 vector <Mesh*> hangarModel;
@@ -71,6 +153,12 @@ vector <Mesh*> gameOverModel;
 vector <Mesh*> skyboxDayModel;
 vector <Mesh*> skyboxNightModel;
 
+// models and impostors of AI aircraft by their types
+vector <Mesh*> *trafficModels[TRAFFIC_TYPES_COUNT] = {&jetPlaneModel, &fighterPlaneModel, &retroPlaneModel, &helicopterModel};
+Impostor **trafficImpostors[TRAFFIC_TYPES_COUNT] = {&jetPlaneImpostor, &fighterPlaneImpostor, &retroPlaneImpostor, &helicopterImpostor};
+vector <mat4> nearInstances[TRAFFIC_TYPES_COUNT]; // filled by workers, drawn by the main thread
+vector <mat4> farInstances[TRAFFIC_TYPES_COUNT];
+
 // matrices
 mat4 pMat = mat4(1.0f);
 mat4 vMat = mat4(1.0f);
@@ -88,6 +176,41 @@ bool runwayCamOn     = false;
 bool helicopterCamOn = false;
 bool airportExhCamOn = false;
 
+// parameters of the renderer
+bool rayPickingOn = true;
+bool hudOn        = false;
+int winW          = WIN_WIDTH;
+int winH          = WIN_HEIGHT;
+
+// simulation thread and its exchange with the renderer
+thread simThread;
+atomic <bool> simRunning(false);
+Clock *simClock = nullptr; // time of the simulation loop and of the interpolation
+OffscreenContext *offscreen = nullptr; // frames end here instead of the window (benchmark runs)
+
+// recording and replaying of the input
+InputJournal *journal = nullptr;
+string journalFile;
+unsigned int simSteps      = 0;
+unsigned int trafficSeed   = TRAFFIC_SEED;
+unsigned int schedulerSeed = SCHEDULER_SEED;
+
+// durations of the stages of frames and steps
+Profiler *profiler = nullptr;
+string traceFile;
+
+// counters of the renderer shown over the picture
+Hud *hud = nullptr;
+RenderStats renderStats;
+TripleBuffer <Snapshot> snapshots;
+SpscQueue <InputEvent, INPUT_QUEUE_SIZE> inputs;
+unsigned int sceneVersion      = 0; // simulation side
+unsigned int drawnSceneVersion = 0; // renderer side
+
+// counters of AI aircraft shown in the title
+size_t trafficDrawn = 0;
+double titleTime    = 0.0;
+
 // last free camera position
 vec3 lastFreeCamPos     = CAM_DEF_POS;
 float lastFreeCamAngleX = 0.0f;
@@ -108,23 +231,52 @@ void createPrograms()
 	skyboxProg = createProgram({createShaderFromFile(GL_VERTEX_SHADER, VS_SKYBOX_SRC), createShaderFromFile(GL_FRAGMENT_SHADER, FS_SKYBOX_SRC)});
 	explosionProg = createProgram({createShaderFromFile(GL_VERTEX_SHADER, VS_EXPLOSION_SRC), createShaderFromFile(GL_FRAGMENT_SHADER, FS_EXPLOSION_SRC)});
 	gameOverProg = createProgram({createShaderFromFile(GL_VERTEX_SHADER, VS_GAME_OVER_SRC), createShaderFromFile(GL_FRAGMENT_SHADER, FS_GAME_OVER_SRC)});
+	occlusionProg = createProgram({createShaderFromFile(GL_VERTEX_SHADER, VS_OCCLUSION_SRC), createShaderFromFile(GL_FRAGMENT_SHADER, FS_OCCLUSION_SRC)});
+	impostorProg = createProgram({createShaderFromFile(GL_VERTEX_SHADER, VS_IMPOSTOR_SRC), createShaderFromFile(GL_FRAGMENT_SHADER, FS_IMPOSTOR_SRC)});
+	upscaleProg = createProgram({createShaderFromFile(GL_VERTEX_SHADER, VS_UPSCALE_SRC), createShaderFromFile(GL_FRAGMENT_SHADER, FS_UPSCALE_SRC)});
+	instancedProg = createProgram({createShaderFromFile(GL_VERTEX_SHADER, VS_INSTANCED_SRC), createShaderFromFile(GL_FRAGMENT_SHADER, FS_MAIN_SRC)});
+	instImpProg = createProgram({createShaderFromFile(GL_VERTEX_SHADER, VS_INST_IMP_SRC), createShaderFromFile(GL_FRAGMENT_SHADER, FS_IMPOSTOR_SRC)});
+	hudProg = createProgram({createShaderFromFile(GL_VERTEX_SHADER, VS_HUD_SRC), createShaderFromFile(GL_FRAGMENT_SHADER, FS_HUD_SRC)});
 } // CREATE PROGRAMS
 
 // ========================================
 
+/** Renders the model from all directions into a new impostor. */
+Impostor *createImpostor(vector <Mesh*> &model)
+{
+	Impostor *impostor = new Impostor(impostorProg, IMPOSTOR_FRAMES, IMPOSTOR_RES);
+	impostor->bake(mainProg, model, SUN_POS);
+
+	return impostor;
+} // CREATE IMPOSTOR
+
+// ========================================
+
 void createModels()
 {
-	loadModel(ISLAND_MODEL_SRC, mainProg, islandModel);
-	loadModel(RUNWAY_MODEL_SRC, mainProg, runwayModel);
-	loadModel(HANGAR_MODEL_SRC, mainProg, hangarModel);
-	loadModel(TOWER_MODEL_SRC, mainProg, towerModel);
-	loadModel(ANTENNA_MODEL_SRC, mainProg, antennaModel);
-	loadModel(JET_MODEL_SRC, mainProg, jetPlaneModel);
-	loadModel(FIGHTER_MODEL_SRC, mainProg, fighterPlaneModel);
-	loadModel(RETRO_MODEL_SRC, mainProg, retroPlaneModel);
-	loadModel(HELICOPTER_MODEL_SRC, mainProg, helicopterModel);
-	loadModel(STONE_MODEL_SRC, mainProg, stoneModel);
-	loadModel(LAMP_MODEL_SRC, mainProg, lampModel);
+	Job *bvhBuilds = jobs->create(nullptr); // hierarchies are built by workers while next models are loading
+
+	loadModel(ISLAND_MODEL_SRC, mainProg, islandModel, &islandBvh, bvhBuilds);
+	loadModel(RUNWAY_MODEL_SRC, mainProg, runwayModel, &runwayBvh, bvhBuilds);
+	loadModel(HANGAR_MODEL_SRC, mainProg, hangarModel, &hangarBvh, bvhBuilds);
+	loadModel(TOWER_MODEL_SRC, mainProg, towerModel, &towerBvh, bvhBuilds);
+	loadModel(ANTENNA_MODEL_SRC, mainProg, antennaModel, &antennaBvh, bvhBuilds);
+	loadModel(JET_MODEL_SRC, mainProg, jetPlaneModel, &jetPlaneBvh, bvhBuilds);
+	loadModel(FIGHTER_MODEL_SRC, mainProg, fighterPlaneModel, &fighterPlaneBvh, bvhBuilds);
+	loadModel(RETRO_MODEL_SRC, mainProg, retroPlaneModel, &retroPlaneBvh, bvhBuilds);
+	loadModel(HELICOPTER_MODEL_SRC, mainProg, helicopterModel, &helicopterBvh, bvhBuilds);
+	loadModel(STONE_MODEL_SRC, mainProg, stoneModel, &stoneBvh, bvhBuilds);
+	loadModel(LAMP_MODEL_SRC, mainProg, lampModel, &lampBvh, bvhBuilds);
+
+	spotLightBvh.addTriangles(spotLightData, 8, spotLightIndices, sizeof(spotLightIndices) / (3 * sizeof(unsigned)));
+	jobs->spawn([] {spotLightBvh.build();}, bvhBuilds);
+
+	if (!mainProg) // headless run has no programs, only the hierarchies for collisions are needed
+	{
+		jobs->run(bvhBuilds);
+		jobs->wait(bvhBuilds);
+		return;
+	} // if
 
 	// set explosion model
 	Mesh* explosionMesh = new Mesh();
@@ -162,13 +314,30 @@ void createModels()
 		SKYBOX_NIGHT_POS_Z_SRC, SKYBOX_NIGHT_NEG_Z_SRC
 	);
 	skyboxNightModel.push_back(skyboxNightMesh);
+
+	// set occlusion culler with its bounding box model
+	culler = new Culler(occlusionProg);
+
+	// set impostors for distant objects
+	hangarImpostor = createImpostor(hangarModel);
+	stoneImpostor = createImpostor(stoneModel);
+	towerImpostor = createImpostor(towerModel);
+	antennaImpostor = createImpostor(antennaModel);
+	jetPlaneImpostor = createImpostor(jetPlaneModel);
+	fighterPlaneImpostor = createImpostor(fighterPlaneModel);
+	retroPlaneImpostor = createImpostor(retroPlaneModel);
+	helicopterImpostor = createImpostor(helicopterModel);
+
+	jobs->run(bvhBuilds);
+	jobs->wait(bvhBuilds); // collisions and the terrain need all hierarchies
 } // CREATE MODELS
 
 // ========================================
 
-void createObjects()
+/** Creates everything what never changes, it is shared by the simulation and the renderer. */
+void createScenery()
 {
-	lights.push_back(new Light(vec3(-0.5f, 1.0f, -1.0f), vec3(0.0f), vec3(0.0f), vec3(1.0f, 1.0f, 0.5f), vec3(1.0f), 0.0f, 0.0f)); // sun
+	lights.push_back(new Light(SUN_POS, vec3(0.0f), vec3(0.0f), vec3(1.0f, 1.0f, 0.5f), vec3(1.0f), 0.0f, 0.0f)); // sun
 	lights.push_back(new Light(CAM_DEF_POS, -Z_AXIS, vec3(0.2f), vec3(1.0f), vec3(1.0f), 0.92f, 15.0f)); // flashlight
 
 	// lamp lights
@@ -189,8 +358,6 @@ void createObjects()
 
 	// ****************************************
 
-	cam = new Camera(CAM_DEF_POS, CAM_DEF_DIR, CAM_DEF_UP);
-	state = new State(WIN_WIDTH, WIN_HEIGHT, lights.size());
 	skybox = new Skybox();
 
 	// ****************************************
@@ -203,12 +370,6 @@ void createObjects()
 	hangars.push_back(new Object(vec3(-14.0f, 2.2f, 18.5f), vec3(0.0f), vec3(5.0f), vec3(5.25f, 5.0f, 5.0f), vec3(0.0f, 90.0f, 0.0f)));
 	hangars.push_back(new Object(vec3(-14.0f, 2.2f, 8.0f), vec3(0.0f), vec3(5.0f), vec3(5.25f, 5.0f, 5.0f), vec3(0.0f, 90.0f, 0.0f)));
 
-	helicopter = new Helicopter(vec3(0.0f), vec3(0.0f), vec3(2.5f), vec3(2.5f, 1.25f, 2.5f), vec3(0.0f), 0.3f, 0.001f * (float)glutGet(GLUT_ELAPSED_TIME));
-
-	jetPlane = new Object(vec3(-5.25f, 0.6f, 18.9f), XZ_AXIS, vec3(2.5f), vec3(2.75f, 0.75f, 2.75f), vec3(0.0f, 45.0f, 0.0f), 0.0f, 0.5f, 0.001f);
-	fighterPlane = new Object(vec3(-5.25f, 0.81f, 12.9f), XZ_AXIS, vec3(2.5f), vec3(2.5f, 0.75f, 2.5f), vec3(0.0f, 45.0f, 0.0f), 0.0f, 0.7f, 0.002f);
-	retroPlane = new Object(vec3(-5.25f, 0.5f, 6.9f), XZ_AXIS, vec3(1.5f), vec3(2.0f, 0.75f, 2.0f), vec3(3.0f, 45.0f, 0.0f), 0.0f, 0.3f, 0.0015f);
-
 	stones.push_back(new Object(vec3(-0.5f, 0.0f, 45.0f), vec3(0.0f), vec3(6.0f), vec3(5.5f, 3.25f, 6.25f), vec3(0.0f, 225.0f, 0.0f)));
 	stones.push_back(new Object(vec3(-17.0f, -2.5f, -29.5f), vec3(0.0f), vec3(9.0f), vec3(7.0f, 5.25f, 9.25f), vec3(0.0f, 10.0f, 0.0f)));
 
@@ -225,149 +386,515 @@ void createObjects()
 
 	for (int i = 0; i < 5; i++) // right runway lights
 		spotLights.push_back(new Object(vec3(14.25f, 0.0f, 39.55f - i * 19.76f), vec3(0.0f), vec3(0.05f), vec3(0.0f), vec3(0.0f)));
-} // CREATE OBJECTS
+
+	// ****************************************
+
+	// ids for picking
+	unsigned int id = 2;
+	for (auto it : lamps)
+		it->setId(id++);
+
+	for (auto it : spotLights)
+		it->setId(id++);
+
+	// ****************************************
+
+	island->setBvh(&islandBvh);
+	runway->setBvh(&runwayBvh);
+	tower->setBvh(&towerBvh);
+	antenna->setBvh(&antennaBvh);
+
+	for (auto it : hangars)
+		it->setBvh(&hangarBvh);
+
+	for (auto it : stones)
+		it->setBvh(&stoneBvh);
+
+	for (auto it : lamps)
+		it->setBvh(&lampBvh);
+
+	for (auto it : spotLights)
+		it->setBvh(&spotLightBvh);
+
+	// ****************************************
+
+	for (auto it : hangars)
+		it->setImpostor(hangarImpostor);
+
+	for (auto it : stones)
+		it->setImpostor(stoneImpostor);
+
+	tower->setImpostor(towerImpostor);
+	antenna->setImpostor(antennaImpostor);
+
+	// ****************************************
+
+	// collidable objects (grid needs their meshes for bounds)
+	for (auto it : hangars)
+		it->setInBox(vec3(6.0f, 3.0f, 3.0f)); // player can walk inside
+
+	grid->insert(tower);
+	grid->insert(antenna);
+
+	for (auto it : hangars)
+		grid->insert(it);
+
+	for (auto it : stones)
+		grid->insert(it);
+} // CREATE SCENERY
+
+// ========================================
+
+/** Creates everything what the simulation changes (again after restart). */
+void createVehicles()
+{
+	cam = new Camera(CAM_DEF_POS, CAM_DEF_DIR, CAM_DEF_UP);
+	state = new State(WIN_WIDTH, WIN_HEIGHT, lights.size());
+
+	helicopter = new Helicopter(vec3(0.0f), vec3(0.0f), vec3(2.5f), vec3(2.5f, 1.25f, 2.5f), vec3(0.0f), HELICOPTER_SPEED, state->getElapsedTime());
+
+	jetPlane = new Object(vec3(-5.25f, 0.6f, 18.9f), XZ_AXIS, vec3(2.5f), vec3(2.75f, 0.75f, 2.75f), vec3(0.0f, 45.0f, 0.0f), 0.0f, 0.5f, 0.001f);
+	fighterPlane = new Object(vec3(-5.25f, 0.81f, 12.9f), XZ_AXIS, vec3(2.5f), vec3(2.5f, 0.75f, 2.5f), vec3(0.0f, 45.0f, 0.0f), 0.0f, 0.7f, 0.002f);
+	retroPlane = new Object(vec3(-5.25f, 0.5f, 6.9f), XZ_AXIS, vec3(1.5f), vec3(2.0f, 0.75f, 2.0f), vec3(3.0f, 45.0f, 0.0f), 0.0f, 0.3f, 0.0015f);
+
+	// ****************************************
+
+	// ids for picking
+	helicopter->setId(40);
+	jetPlane->setId(41);
+	fighterPlane->setId(42);
+	retroPlane->setId(43);
+
+	jetPlane->setBvh(&jetPlaneBvh);
+	fighterPlane->setBvh(&fighterPlaneBvh);
+	retroPlane->setBvh(&retroPlaneBvh);
+	helicopter->setBvh(&helicopterBvh);
+
+	jetPlane->setImpostor(jetPlaneImpostor);
+	fighterPlane->setImpostor(fighterPlaneImpostor);
+	retroPlane->setImpostor(retroPlaneImpostor);
+	helicopter->setImpostor(helicopterImpostor);
+
+	for (auto it : {jetPlane, fighterPlane, retroPlane, helicopter})
+		grid->insert(it);
+
+	scheduler = new Scheduler(entities, ARRIVALS_PER_HOUR, DEPARTS_PER_HOUR, schedulerSeed); // starts with the elapsed time
+} // CREATE VEHICLES
+
+// ========================================
+
+/** Creates the world the simulation runs in, nothing of it needs the GPU. */
+void createWorld()
+{
+	grid = new SpatialGrid(SCENE_WIDTH, SCENE_DEPTH, GRID_CELL_SIZE);
+	helicopterPath = new SplinePath(helicopterCurveData, helicopterCurveSize);
+	airportExhPath = new SplinePath(airportExhCurveData, airportExhCurveSize);
+	arrivalPath = new SplinePath(arrivalCurveData, arrivalCurveSize, false);
+	departurePath = new SplinePath(departureCurveData, departureCurveSize, false);
+	holdingPath = new SplinePath(holdingCurveData, holdingCurveSize);
+	createScenery();
+	entities->freeze(); // renderer reads the scenery directly, the rest through snapshots
+	createVehicles();
+
+	traffic = new Traffic(entities, arrivalPath, departurePath, holdingPath, TRAFFIC_AIRCRAFT, trafficSeed);
+	entities->updateMatrices(jobs); // the first snapshot is published before any step
+
+	// heights of the island and the runway are sampled only once
+	vec3 islandMin, islandMax, runwayMin, runwayMax;
+	island->getBounds(islandMin, islandMax);
+	runway->getBounds(runwayMin, runwayMax);
+
+	vec3 groundMin = min(islandMin, runwayMin), groundMax = max(islandMax, runwayMax);
+	vector <Object*> ground = {island, runway};
+
+	heightfield = new Heightfield(vec2(groundMin.x, groundMin.z), vec2(groundMax.x, groundMax.z), TERRAIN_CELL_SIZE);
+	heightfield->sample(ground, groundMax.y + 1.0f, groundMin.y, jobs);
+} // CREATE WORLD
 
 // ========================================
 
 void init()
 {
 	glClearColor(MIST_COL, MIST_COL, MIST_COL, 1.0f); // set default ambient color
-	glClearStencil(100); // set initial value for stencil buffer
 	glEnable(GL_DEPTH_TEST); // enable depth buffer
 	glDepthMask(GL_TRUE); // enable modifying depth buffer
 
+	jobs = new JobSystem();
+	entities = new EntityStore(MAX_ENTITIES);
+
+	profiler->initGpu();
 	createPrograms();
 	createModels();
-	createObjects();
+	createWorld();
+
+	// scene is rendered offscreen with dynamic resolution
+	sceneTarget = new RenderTarget(WIN_WIDTH, WIN_HEIGHT);
+	staticCache = new StaticCache(WIN_WIDTH, WIN_HEIGHT);
+	scaler = new Scaler(upscaleProg, FRAME_BUDGET);
+	picker = new Picker();
+	instancer = new Instancer(instancedProg, instImpProg);
+	hud = new Hud(hudProg);
 } // INIT
 
 // ========================================
-// DISPLAY MANAGEMENT
+// PICKING
 // ========================================
 
-void onDisplay()
+/** Reacts to the clicked object (simulation thread). */
+void onPick(unsigned int clickedID)
 {
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT); // clear buffers
-	vMat = cam->getVMatrix(); // set view matrix
+	if (planeModeOn) return; // not working when flying
 
-	// position and direction of flashlight
-	if (planeModeOn) // player is flying
+	// ****************************************
+
+	if ((clickedID >= 2) && (clickedID <= 17)) // lights
 	{
-		lights[1]->setPos((*cam->getPlane())->getPos() + 2.0f * normalize((*cam->getPlane())->getDir()));
-		lights[1]->setDir(normalize((*cam->getPlane())->getDir()));
+		state->setLight(clickedID, !state->getLight(clickedID));
+		sceneVersion++;
 	} // if
-	else // player is walking
-	{
-		lights[1]->setPos(cam->getPos());
-		lights[1]->setDir(cam->getDir());
-	} // else
+	else if (helicopter && (clickedID == helicopter->getId())) // helicopter
+		destroyObject(&helicopter);
+	else if (jetPlane && (clickedID == jetPlane->getId())) // jet plane
+		destroyObject(&jetPlane);
+	else if (fighterPlane && (clickedID == fighterPlane->getId())) // fighter plane
+		destroyObject(&fighterPlane);
+	else if (retroPlane && (clickedID == retroPlane->getId())) // old plane
+		destroyObject(&retroPlane);
+} // ON PICK
 
-	// ****************************************
-	
-	glUseProgram(mainProg);
+// ========================================
+// DISPLAY MANAGEMENT
+// ========================================
+
+/** Stage of the frame graph, only the whole frame is waited for, so the stage deletes itself. */
+Job* createStage(function <void()> task, Job *frame, bool mainThread)
+{
+	Job *stage = jobs->create(task, frame, mainThread);
+	stage->autoDelete = true;
+
+	return stage;
+} // CREATE STAGE
+
+// ========================================
+
+/** Sends the lights and the look of the day to every program that shades the scene. */
+void sendLights(Snapshot &snap)
+{
+	ProfileScope scope("lights");
 
-	// send lights to vertex shader
-	for (int i = 0; i < (int)lights.size(); i++)
+	for (auto program : {mainProg, instancedProg}) // instanced aircraft are lit the same way
 	{
-		string index = to_string(i);
+		glUseProgram(program);
 
-		if (!state->getLight(i))
-		{
-			glUniform3fv(glGetUniformLocation(mainProg, ("lights[" + index + "].amb").c_str()), 1, value_ptr(vec3(0.0f)));
-			glUniform3fv(glGetUniformLocation(mainProg, ("lights[" + index + "].dif").c_str()), 1, value_ptr(vec3(0.0f)));
-			glUniform3fv(glGetUniformLocation(mainProg, ("lights[" + index + "].spe").c_str()), 1, value_ptr(vec3(0.0f)));
-		} // if
-		else
+		// send lights to vertex shader
+		for (int i = 0; i < (int)lights.size(); i++)
 		{
-			glUniform3fv(glGetUniformLocation(mainProg, ("lights[" + index + "].pos").c_str()), 1, value_ptr(lights[i]->getPos()));
-			glUniform3fv(glGetUniformLocation(mainProg, ("lights[" + index + "].dir").c_str()), 1, value_ptr(lights[i]->getDir()));
-			glUniform3fv(glGetUniformLocation(mainProg, ("lights[" + index + "].amb").c_str()), 1, value_ptr(lights[i]->getAmb()));
-			glUniform3fv(glGetUniformLocation(mainProg, ("lights[" + index + "].dif").c_str()), 1, value_ptr(lights[i]->getDif()));
-			glUniform3fv(glGetUniformLocation(mainProg, ("lights[" + index + "].spe").c_str()), 1, value_ptr(lights[i]->getSpe()));
-			glUniform1f(glGetUniformLocation(mainProg, ("lights[" + index + "].cosCutOff").c_str()), lights[i]->getCosCutOff());
-			glUniform1f(glGetUniformLocation(mainProg, ("lights[" + index + "].expo").c_str()), lights[i]->getExpo());
-		} // else
+			string index = to_string(i);
+			renderStats.uniforms += snap.state.getLight(i) ? 7 : 3;
+
+			if (!snap.state.getLight(i))
+			{
+				glUniform3fv(glGetUniformLocation(program, ("lights[" + index + "].amb").c_str()), 1, value_ptr(vec3(0.0f)));
+				glUniform3fv(glGetUniformLocation(program, ("lights[" + index + "].dif").c_str()), 1, value_ptr(vec3(0.0f)));
+				glUniform3fv(glGetUniformLocation(program, ("lights[" + index + "].spe").c_str()), 1, value_ptr(vec3(0.0f)));
+			} // if
+			else
+			{
+				glUniform3fv(glGetUniformLocation(program, ("lights[" + index + "].pos").c_str()), 1, value_ptr(lights[i]->getPos()));
+				glUniform3fv(glGetUniformLocation(program, ("lights[" + index + "].dir").c_str()), 1, value_ptr(lights[i]->getDir()));
+				glUniform3fv(glGetUniformLocation(program, ("lights[" + index + "].amb").c_str()), 1, value_ptr(lights[i]->getAmb()));
+				glUniform3fv(glGetUniformLocation(program, ("lights[" + index + "].dif").c_str()), 1, value_ptr(lights[i]->getDif()));
+				glUniform3fv(glGetUniformLocation(program, ("lights[" + index + "].spe").c_str()), 1, value_ptr(lights[i]->getSpe()));
+				glUniform1f(glGetUniformLocation(program, ("lights[" + index + "].cosCutOff").c_str()), lights[i]->getCosCutOff());
+				glUniform1f(glGetUniformLocation(program, ("lights[" + index + "].expo").c_str()), lights[i]->getExpo());
+			} // else
+		} // for
+
+		// send other data to vertex shader
+		glUniform1i(glGetUniformLocation(program, DAY_ON_VAR), snap.dayOn);
+		glUniform1i(glGetUniformLocation(program, FLA_ON_VAR), snap.flashlightOn);
+		glUniform1i(glGetUniformLocation(program, MIST_ON_VAR), snap.mistOn);
+		glUniform1f(glGetUniformLocation(program, MIST_DEN_VAR), MIST_DEN);
+		glUniform1f(glGetUniformLocation(program, MIST_COL_VAR), MIST_COL);
+		renderStats.addProgram(5);
 	} // for
 
-	// send other data to vertex shader
-	glUniform1i(glGetUniformLocation(mainProg, DAY_ON_VAR), dayOn);
-	glUniform1i(glGetUniformLocation(mainProg, FLA_ON_VAR), flashlightOn);
-	glUniform1i(glGetUniformLocation(mainProg, MIST_ON_VAR), mistOn);
-	glUniform1f(glGetUniformLocation(mainProg, MIST_DEN_VAR), MIST_DEN);
-	glUniform1f(glGetUniformLocation(mainProg, MIST_COL_VAR), MIST_COL);
+	for (auto program : {impostorProg, instImpProg})
+	{
+		glUseProgram(program);
+
+		// send the same data to impostors
+		glUniform1i(glGetUniformLocation(program, DAY_ON_VAR), snap.dayOn);
+		glUniform1i(glGetUniformLocation(program, MIST_ON_VAR), snap.mistOn);
+		glUniform1f(glGetUniformLocation(program, MIST_DEN_VAR), MIST_DEN);
+		glUniform1f(glGetUniformLocation(program, MIST_COL_VAR), MIST_COL);
+		renderStats.addProgram(4);
+	} // for
 
 	glUseProgram(0);
+} // SEND LIGHTS
 
-	// ****************************************
-	
-	if (dayOn && !mistOn) // draw skybox for day
-		skybox->draw(skyboxProg, skyboxDayModel, pMat, vMat, mMat);
-	else if (!dayOn && !mistOn) // draw skybox for night
-		skybox->draw(skyboxProg, skyboxNightModel, pMat, vMat, mMat);
+// ========================================
 
-	island->draw(mainProg, islandModel, pMat, vMat, mMat);
-	runway->draw(mainProg, runwayModel, pMat, vMat, mMat);
-	tower->draw(mainProg, towerModel, pMat, vMat, mMat);
-	antenna->draw(mainProg, antennaModel, pMat, vMat, mMat);
+/** Draws everything what never moves (it can be cached for static cameras). */
+void drawStaticScene(bool cullingOn, Snapshot &snap)
+{
+	{
+		ProfileScope scope("skybox", true);
 
-	for (auto it : hangars)
-		it->draw(mainProg, hangarModel, pMat, vMat, mMat);
+		if (snap.dayOn && !snap.mistOn) // draw skybox for day
+			skybox->draw(skyboxProg, skyboxDayModel, pMat, vMat, mMat);
+		else if (!snap.dayOn && !snap.mistOn) // draw skybox for night
+			skybox->draw(skyboxProg, skyboxNightModel, pMat, vMat, mMat);
+	}
 
-	for (auto it : stones)
-		it->draw(mainProg, stoneModel, pMat, vMat, mMat);
+	{
+		ProfileScope scope("scenery", true);
 
-	for (auto it : explosions)
-		it->draw(explosionProg, explosionModel, pMat, vMat, mMat);
+		island->draw(mainProg, islandModel, pMat, vMat, mMat);
+		runway->draw(mainProg, runwayModel, pMat, vMat, mMat);
+		tower->draw(mainProg, towerModel, pMat, vMat, mMat);
+		antenna->draw(mainProg, antennaModel, pMat, vMat, mMat);
+
+		for (auto it : hangars)
+			it->draw(mainProg, hangarModel, pMat, vMat, mMat);
+
+		for (auto it : stones)
+			it->draw(mainProg, stoneModel, pMat, vMat, mMat);
+	}
 
-	if (gameOver)
-		gameOver->draw(gameOverProg, gameOverModel, pMat, vMat, mMat);
-	
 	// ****************************************
-	
-	glEnable(GL_STENCIL_TEST);
-	glStencilOp(GL_KEEP /* stencil test failed */, GL_KEEP /* stancil test passed, depth test failed */, GL_REPLACE /* both tests passed */);
 
-	if (helicopter) // draw helicopter if exists
+	if (cullingOn) // test bounding boxes against the static scene (results are read in one of next frames)
 	{
-		glStencilFunc(GL_ALWAYS /* stencil test always passes */, 40 /* value in stencil buffer */, 255 /* mask */);
-		helicopter->draw(mainProg, helicopterModel, pMat, vMat, mMat);
+		for (auto it : lamps)
+			culler->query(it->getId(), it->getPos(), vec3(length(it->getSize())), snap.cam.getPos(), pMat, vMat);
+
+		for (auto it : spotLights)
+			culler->query(it->getId(), it->getPos(), vec3(length(it->getSize())), snap.cam.getPos(), pMat, vMat);
 	} // if
 
-	if (jetPlane) // draw jet plane if exists
+	// ****************************************
+
 	{
-		glStencilFunc(GL_ALWAYS, 41, 255);
-		jetPlane->draw(mainProg, jetPlaneModel, pMat, vMat, mMat);
-	} // if
+		ProfileScope scope("lamps", true);
+
+		for (auto it : lamps) // draw all visible lamps
+			if (!cullingOn || culler->isVisible(it->getId()))
+				it->draw(mainProg, lampModel, pMat, vMat, mMat);
+	}
+
+	{
+		ProfileScope scope("spot lights", true);
+
+		for (auto it : spotLights) // draw all visible spot lights
+			if (!cullingOn || culler->isVisible(it->getId()))
+				it->draw(mainProg, spotLightModel, pMat, vMat, mMat);
+	}
+} // DRAW STATIC SCENE
+
+// ========================================
+
+/** Builds the matrices of visible AI aircraft of one model, near ones and far ones apart (no GL, it runs on a worker). */
+void cullTraffic(Snapshot &snap, int type)
+{
+	ProfileScope scope("traffic matrices");
+	EntityStore &s = snap.store;
+	vec3 eye = instancer->getEye();
+
+	nearInstances[type].clear();
+	farInstances[type].clear();
+
+	for (auto i : snap.traffic[type])
+	{
+		vec3 pos = mix(s.prevPos[i], s.pos[i], Object::alpha); // rotation of the current step is close enough
+		if (!instancer->isVisible(pos, TRAFFIC_RADIUS * s.size[i].x)) continue;
+
+		mat4 world = s.world[i];
+		world[3] = vec4(pos.x, pos.y, pos.z, 1.0f);
+
+		if (distance(eye, pos) < TRAFFIC_LOD_DIST)
+			nearInstances[type].push_back(world);
+		else
+			farInstances[type].push_back(world);
+	} // for
+} // CULL TRAFFIC
+
+// ========================================
+
+/** Draws AI aircraft with two instanced calls per model, near ones whole and far ones as impostors. */
+void drawTraffic()
+{
+	ProfileScope scope("traffic", true);
+	trafficDrawn = 0;
+
+	for (int type = 0; type < TRAFFIC_TYPES_COUNT; type++)
+	{
+		instancer->drawModels(*trafficModels[type], nearInstances[type]);
+		instancer->drawImpostors(*trafficImpostors[type], farInstances[type]);
+		trafficDrawn += nearInstances[type].size() + farInstances[type].size();
+	} // for
+} // DRAW TRAFFIC
+
+// ========================================
+
+/** Draws vehicles and effects over the static scene. */
+void drawDynamicScene(Snapshot &snap)
+{
+	for (auto &it : snap.explosions)
+		it.draw(explosionProg, explosionModel, pMat, vMat, mMat);
+
+	for (auto &it : snap.gameOver)
+		it.draw(gameOverProg, gameOverModel, pMat, vMat, mMat);
+
+	// ****************************************
+
+	// test bounding boxes against the static scene (results are read in one of next frames)
+	for (auto &it : snap.helicopter)
+		culler->query(it.getId(), it.getPos(), vec3(length(it.getSize())), snap.cam.getPos(), pMat, vMat);
+
+	for (auto &it : snap.planes)
+		culler->query(it.object.getId(), it.object.getPos(), vec3(length(it.object.getSize())), snap.cam.getPos(), pMat, vMat);
+
+	// ****************************************
+
+	{
+		ProfileScope scope("vehicles", true);
+
+		for (auto &it : snap.helicopter) // draw helicopter if exists and is not hidden
+			if (culler->isVisible(it.getId()))
+				it.draw(mainProg, helicopterModel, pMat, vMat, mMat);
+
+		for (auto &it : snap.planes) // draw planes if exist and are not hidden
+			if (culler->isVisible(it.object.getId()))
+				it.object.draw(mainProg, *it.model, pMat, vMat, mMat);
+	}
+} // DRAW DYNAMIC SCENE
+
+// ========================================
+
+void onDisplay()
+{
+	profiler->beginFrame(); // GPU times of an older frame are ready by now
+	ProfileScope frameScope("frame", true);
 
-	if (fighterPlane) // draw fighter plane if exists
+	renderStats.clear();
+	hud->update();
+
+	unsigned int clickedID = 0;
+	if (picker->poll(clickedID)) // object id of the last click has arrived
 	{
-		glStencilFunc(GL_ALWAYS, 42, 255);
-		fighterPlane->draw(mainProg, fighterPlaneModel, pMat, vMat, mMat);
+		InputEvent event = InputEvent();
+		event.type = INPUT_PICK;
+		event.id = clickedID;
+		inputs.push(event);
 	} // if
 
-	if (retroPlane) // draw old plane if exists
+	jobs->runMainJobs(); // GL work handed over by other threads
+
+	snapshots.acquire(); // take the newest step if the simulation has published one
+	Snapshot &snap = snapshots.getFront();
+
+	// draw between the last two simulation steps
+	Object::alpha = clamp((float)((simClock->getTime() - snap.time) / SIM_STEP), 0.0f, 1.0f);
+
+	if (snap.sceneVersion != drawnSceneVersion) // lights, day or mist have changed
 	{
-		glStencilFunc(GL_ALWAYS, 43, 255);
-		retroPlane->draw(mainProg, retroPlaneModel, pMat, vMat, mMat);
+		staticCache->invalidate();
+		drawnSceneVersion = snap.sceneVersion;
 	} // if
 
-	int id = 2;
-	for (auto it : lamps) // draw all lamps
+	scaler->update(); // adapt resolution to the last measured frames
+
+	GLsizei width = (GLsizei)(scaler->getScale() * winW);
+	GLsizei height = (GLsizei)(scaler->getScale() * winH);
+
+	// render into the scaled part of the target
+	glBindFramebuffer(GL_FRAMEBUFFER, sceneTarget->getFbo());
+	glViewport(0, 0, width, height);
+	scaler->begin();
+
+	// clear buffers
+	const GLfloat clearColor[] = {MIST_COL, MIST_COL, MIST_COL, 1.0f};
+	const GLuint clearID[] = {0, 0, 0, 0};
+	glClearBufferfv(GL_COLOR, 0, clearColor);
+	glClearBufferuiv(GL_COLOR, 1, clearID);
+	glClear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+	vMat = snap.cam.getVMatrix(Object::alpha); // set view matrix between the last two simulation steps
+
+	// position and direction of flashlight
+	lights[1]->setPos(snap.flashlightPos);
+	lights[1]->setDir(snap.flashlightDir);
+
+	// ****************************************
+
+	// GL stages follow each other on this thread while workers build the matrices of AI aircraft
+	instancer->begin(pMat, vMat); // frustum of the frame for the workers
+	Job *frame = jobs->create(nullptr);
+
+	Job *lightsStage = createStage([&snap] {sendLights(snap);}, frame, true);
+	Job *staticStage = createStage([&snap, width, height]
 	{
-		glStencilFunc(GL_ALWAYS, id++, 255);
-		it->draw(mainProg, lampModel, pMat, vMat, mMat);
-	} // for
+		ProfileScope scope("static scene", true);
+
+		if ((snap.view != VIEW_NONE) && staticCache->isValid(snap.view, scaler->getScale())) // static camera sees the same picture
+			staticCache->restore(sceneTarget, width, height);
+		else if (snap.view != VIEW_NONE) // render the picture once for the static camera
+		{
+			drawStaticScene(false, snap);
+			staticCache->store(sceneTarget, width, height, snap.view, scaler->getScale());
+		} // else if
+		else
+			drawStaticScene(true, snap);
+	}, frame, true);
+	Job *dynamicStage = createStage([&snap]
+	{
+		ProfileScope scope("dynamic scene", true);
+		drawDynamicScene(snap);
+	}, frame, true);
+	Job *trafficStage = createStage([] {drawTraffic();}, frame, true);
+
+	jobs->addDependency(staticStage, lightsStage);
+	jobs->addDependency(dynamicStage, staticStage);
+	jobs->addDependency(trafficStage, dynamicStage);
 
-	for (auto it : spotLights) // draw all spot lights
+	for (int type = 0; type < TRAFFIC_TYPES_COUNT; type++) // every model on its own worker
 	{
-		glStencilFunc(GL_ALWAYS, id++, 255);
-		it->draw(mainProg, spotLightModel, pMat, vMat, mMat);
+		Job *cullStage = createStage([&snap, type] {cullTraffic(snap, type);}, frame, false);
+		jobs->addDependency(trafficStage, cullStage);
+		jobs->run(cullStage);
 	} // for
 
-	glDisable(GL_STENCIL_TEST);
+	for (auto it : {lightsStage, staticStage, dynamicStage, trafficStage})
+		jobs->run(it);
+
+	jobs->run(frame);
+	jobs->wait(frame); // GL stages are executed here, in the order of their dependencies
 
 	// ****************************************
 
+	scaler->end();
+	picker->read(sceneTarget, scaler->getScale()); // copy id under the click without waiting
+
+	ProfileScope presentScope("present", true);
+	scaler->present(sceneTarget, winW, winH, offscreen ? offscreen->getScreen()->getFbo() : 0); // upscale to the window
+
+	if (hudOn) // counters of this frame over the upscaled picture
+	{
+		ProfileScope scope("hud", true);
+		hud->draw(renderStats, profiler->getLast("step"), winW, winH);
+	} // if
+
+	if (offscreen) return; // no window to show the frame in
+
+	double time = getWallTime();
+	if (time - titleTime >= 1.0) // counters of AI aircraft once per second
+	{
+		string title = string(WIN_TITLE) + " - aircraft simulated: " + to_string(snap.trafficCount) + ", drawn: " + to_string(trafficDrawn);
+		glutSetWindowTitle(title.c_str());
+		titleTime = time;
+	} // if
+
 	glutSwapBuffers(); // process next data
 } // ON DISPLAY
 
@@ -375,28 +902,115 @@ void onDisplay()
 // CLOSE MANAGEMENT
 // ========================================
 
-void onClose()
+/** Deletes everything what createVehicles has made. */
+void deleteVehicles()
 {
+	for (auto it : {jetPlane, fighterPlane, retroPlane, helicopter})
+		if (it) grid->remove(it);
+
 	deleteComponent(&cam);
 	deleteComponent(&state);
-	deleteComponent(&skybox);
+	deleteComponent(&scheduler);
 
-	deleteComponent(&island);
-	deleteComponent(&runway);
-	deleteComponent(&tower);
-	deleteComponent(&antenna);
 	deleteComponent(&jetPlane);
 	deleteComponent(&fighterPlane);
 	deleteComponent(&retroPlane);
 	deleteComponent(&helicopter);
 	deleteComponent(&gameOver);
 
+	deleteVector(explosions);
+} // DELETE VEHICLES
+
+// ========================================
+
+/** Prints percentiles of all scopes and writes the trace when the run has been profiled. */
+void finishProfiling()
+{
+	if (!profiler->isTracing()) return;
+
+	profiler->printSummary(cout);
+	if (!profiler->writeTrace(traceFile))
+		cerr << "CANNOT WRITE TRACE " << traceFile << endl;
+} // FINISH PROFILING
+
+// ========================================
+
+/** Writes the recorded input with the number of steps it has been recorded for. */
+void closeJournal()
+{
+	if (journal && !journal->isReplaying() && !journal->save(journalFile, simSteps))
+		cerr << "CANNOT WRITE INPUT JOURNAL " << journalFile << endl;
+
+	deleteComponent(&journal);
+} // CLOSE JOURNAL
+
+// ========================================
+
+/** Deletes the world and everything what has run it, the window and the headless run both end here. */
+void deleteWorld()
+{
+	deleteComponent(&traffic);
+	deleteVehicles();
+	deleteComponent(&grid);
+	deleteComponent(&heightfield);
+	deleteComponent(&skybox);
+
+	deleteComponent(&island);
+	deleteComponent(&runway);
+	deleteComponent(&tower);
+	deleteComponent(&antenna);
+
 	deleteVector(hangars);
 	deleteVector(lamps);
 	deleteVector(spotLights);
 	deleteVector(stones);
-	deleteVector(explosions);
 	deleteVector(lights);
+
+	deleteComponent(&helicopterPath);
+	deleteComponent(&airportExhPath);
+	deleteComponent(&arrivalPath);
+	deleteComponent(&departurePath);
+	deleteComponent(&holdingPath);
+
+	deleteComponent(&entities); // after all objects, they free their slots
+	deleteComponent(&jobs);
+	deleteComponent(&simClock);
+
+	closeJournal();
+
+	finishProfiling();
+	deleteComponent(&profiler); // its GPU queries exist only with a window, which is still open here
+} // DELETE WORLD
+
+// ========================================
+
+void onClose()
+{
+	if (simThread.joinable()) // nobody may touch the objects any more
+	{
+		simRunning = false;
+		simThread.join();
+	} // if
+
+	deleteComponent(&instancer);
+	deleteComponent(&sceneTarget);
+	deleteComponent(&staticCache);
+	deleteComponent(&scaler);
+	deleteComponent(&picker);
+	deleteComponent(&culler);
+	deleteComponent(&hud);
+
+	// traffic draws with the impostors of the vehicles, so they are freed here as well
+	deleteComponent(&hangarImpostor);
+	deleteComponent(&stoneImpostor);
+	deleteComponent(&towerImpostor);
+	deleteComponent(&antennaImpostor);
+	deleteComponent(&jetPlaneImpostor);
+	deleteComponent(&fighterPlaneImpostor);
+	deleteComponent(&retroPlaneImpostor);
+	deleteComponent(&helicopterImpostor);
+
+	deleteWorld();
 } // ON CLOSE
 
 // ========================================
@@ -405,12 +1019,14 @@ void onClose()
 
 void onReshape(int newW, int newH)
 {
-	pMat = perspective(radians(60.0f) /* angle */, (float)state->getWinW() / state->getWinH() /* aspect */, 0.1f /* near */, 150.0f /* far */);
+	winW = newW;
+	winH = std::max(newH, 1);
 
-	state->setWinW(newW);
-	state->setWinH(newH);
+	pMat = perspective(radians(60.0f) /* angle */, (float)winW / winH /* aspect */, 0.1f /* near */, 150.0f /* far */);
 
 	glViewport(0 /* x */, 0 /* y */, (GLsizei)newW /* width */, (GLsizei)newH /* height */);
+	sceneTarget->resize(newW, newH);
+	staticCache->resize(newW, newH);
 } // ON RESHAPE
 
 // ========================================
@@ -419,41 +1035,34 @@ void onReshape(int newW, int newH)
 
 void onMouse(int mouseButton, int mouseState, int mouseX, int mouseY)
 {
-	if (planeModeOn) return; // not working when flying
+	if (snapshots.getFront().planeModeOn) return; // not working when flying
 
 	// ****************************************
 
-	if ((mouseButton == GLUT_LEFT_BUTTON) && (mouseState == GLUT_DOWN))
+	if ((mouseButton != GLUT_LEFT_BUTTON) || (mouseState != GLUT_DOWN)) return;
+
+	if (!rayPickingOn)
 	{
-		unsigned char clickedID = 0; // stencil buffer value
+		picker->request(mouseX, winH - mouseY); // object id is read after the next frame
+		return;
+	} // if
 
-		// read value from stencil buffer
-		glReadPixels(mouseX /* x */, state->getWinH() - mouseY /* y */, 1 /* width */, 1 /* height */, GL_STENCIL_INDEX /* format */, GL_UNSIGNED_BYTE /* type */, &clickedID /* data */);
+	// ****************************************
 
-		float time = 0.001f * (float)glutGet(GLUT_ELAPSED_TIME);
-		if ((clickedID >= 2) && (clickedID <= 17)) // lights
-			state->setLight(clickedID, !state->getLight(clickedID));
-		else if (clickedID == 40) // helicopter
-		{
-			explosions.push_back(new Explosion(helicopter->getPos(), Z_AXIS, vec3(2.0f), vec3(0.0f), vec3(0.0f), 0.0f, time));
-			deleteComponent(&helicopter);
-		} // else if
-		else if (clickedID == 41) // jet plane
-		{
-			explosions.push_back(new Explosion(jetPlane->getPos(), Z_AXIS, vec3(2.0f), vec3(0.0f), vec3(0.0f), 0.0f, time));
-			deleteComponent(&jetPlane);
-		} // else if
-		else if (clickedID == 42) // fighter plane
-		{
-			explosions.push_back(new Explosion(fighterPlane->getPos(), Z_AXIS, vec3(2.0f), vec3(0.0f), vec3(0.0f), 0.0f, time));
-			deleteComponent(&fighterPlane);
-		} // else if
-		else if (clickedID == 43) // old plane
-		{
-			explosions.push_back(new Explosion(retroPlane->getPos(), Z_AXIS, vec3(2.0f), vec3(0.0f), vec3(0.0f), 0.0f, time));
-			deleteComponent(&retroPlane);
-		} // else if
-	} // if
+	// unproject the cursor onto the near and far plane of the last drawn view
+	float x = 2.0f * mouseX / winW - 1.0f;
+	float y = 1.0f - 2.0f * mouseY / winH;
+	mat4 invPVMatrix = inverse(pMat * vMat);
+
+	vec4 nearPoint = invPVMatrix * vec4(x, y, -1.0f, 1.0f);
+	vec4 farPoint = invPVMatrix * vec4(x, y, 1.0f, 1.0f);
+
+	// the ray is cast by the simulation, which owns the objects
+	InputEvent event = InputEvent();
+	event.type = INPUT_RAY;
+	event.origin = vec3(nearPoint) / nearPoint.w;
+	event.dir = normalize(vec3(farPoint) / farPoint.w - event.origin);
+	inputs.push(event);
 } // ON MOUSE
 
 // ========================================
@@ -462,112 +1071,290 @@ void onMouse(int mouseButton, int mouseState, int mouseX, int mouseY)
 
 void onMotion(int mouseX, int mouseY)
 {
-	if (state->isGameOver()) return; // not working when game is over
+	if (snapshots.getFront().state.isGameOver()) return; // not working when game is over
 
 	// ****************************************
 
-	if (mouseY != state->getWinH() / 2) // move with camera vertically
-	{
-		float angleY = cam->getAngleY() + CAMERA_SENSITIVITY * (mouseY - state->getWinH() / 2);
-		if (abs(angleY) < CAMERA_ANGLE_MAX) // check top and bottom limit
-			cam->setAngleY(angleY);
-	} // if
+	if ((mouseX == winW / 2) && (mouseY == winH / 2)) return; // pointer has only been bound
 
-	if (mouseX != state->getWinW() / 2) // move with camera horizontally
-	{
-		float angleX = cam->getAngleX() + CAMERA_SENSITIVITY * (mouseX - state->getWinW() / 2);
-		cam->setAngleX(angleX);
-	} // if
+	InputEvent event = InputEvent();
+	event.type = INPUT_MOTION;
+	event.x = mouseX - winW / 2;
+	event.y = mouseY - winH / 2;
+	inputs.push(event);
 
-	glutWarpPointer(state->getWinW() / 2, state->getWinH() / 2); // bind pointer with screen center
-	glutPostRedisplay(); // redraw the window
+	glutWarpPointer(winW / 2, winH / 2); // bind pointer with screen center
 } // ON MOTION
 
 // ========================================
-// TIMER MANAGEMENT
+// KEYBOARD MANAGEMENT
+// ========================================
+
+void onKeyPressed(unsigned char key, int x, int y)
+{
+	switch (key)
+	{
+		case 27: // escape
+			glutLeaveMainLoop(); // finish processing events
+			break;
+		case 'p': case 'P': // ray casting/id buffer picking
+			rayPickingOn = !rayPickingOn;
+			break;
+		default:
+			InputEvent event = InputEvent();
+			event.type = INPUT_KEY_DOWN;
+			event.key = key;
+			inputs.push(event);
+			break;
+	} // switch
+} // ON KEY PRESSED
+
+// ========================================
+
+void onKeyReleased(unsigned char key, int x, int y)
+{
+	InputEvent event = InputEvent();
+	event.type = INPUT_KEY_UP;
+	event.key = key;
+	inputs.push(event);
+} // ON KEY RELEASED
+
+// ========================================
+
+void onSpecialKeyPressed(int key, int x, int y)
+{
+	switch (key)
+	{
+		case GLUT_KEY_F7: // counters of the renderer
+			hudOn = !hudOn;
+			break;
+		default:
+			InputEvent event = InputEvent();
+			event.type = INPUT_SPECIAL_DOWN;
+			event.key = key;
+			inputs.push(event);
+			break;
+	} // switch
+} // ON SPECIAL KEY PRESSED
+
+// ========================================
+
+void onSpecialKeyReleased(int key, int x, int y)
+{
+	InputEvent event = InputEvent();
+	event.type = INPUT_SPECIAL_UP;
+	event.key = key;
+	inputs.push(event);
+} // ON SPECIAL KEY RELEASED
+
+// ========================================
+
+/** Keeps drawing, the simulation runs on its own thread. */
+void onIdle()
+{
+	glutPostRedisplay(); // redraw the window
+} // ON IDLE
+
+// ========================================
+// SIMULATION MANAGEMENT
 // ========================================
 
-void onTimer(int value)
+/** Advances the world by one fixed step, all speeds are given per step. */
+void simulate()
 {
-	state->setElapsedTime(0.001f * (float)glutGet(GLUT_ELAPSED_TIME));
+	// drawing interpolates from here
+	cam->saveState();
+	entities->saveStates(jobs);
+
+	state->setElapsedTime(state->getElapsedTime() + SIM_STEP);
 
 	// ****************************************
 
-	if (helicopter) // update helicopter if exists
 	{
-		helicopter->setCurrTime(state->getElapsedTime());
-		helicopter->update(state, helicopterCurveData, helicopterCurveSize);
-	} // if
+		ProfileScope scope("helicopter");
+
+		if (helicopter) // update helicopter if exists
+		{
+			helicopter->setCurrTime(state->getElapsedTime());
+			helicopter->update(helicopterPath);
+			grid->update(helicopter);
+		} // if
+	}
+
+	{
+		ProfileScope scope("traffic");
+		traffic->update(SIM_STEP, jobs); // AI aircraft are moved by all workers
+	}
+
+	{
+		ProfileScope scope("scheduler");
+		scheduler->advance(state->getElapsedTime()); // landings and take offs of the airport itself
+	}
 
 	if (gameOver) // update game over if exists
 		gameOver->setCurrTime(state->getElapsedTime());
 
-	// update explosion
-	auto it = explosions.begin();
-	while (it != explosions.end())
 	{
-		(*it)->setCurrTime(state->getElapsedTime());
-		if ((*it)->getCurrTime() >= (*it)->getStartTime() + 16.0f /* frames */ * 0.1f /* duration */)
-			it = explosions.erase(it);
-		else
-			it++;
-	} // while
+		ProfileScope scope("explosions");
+
+		// update explosion
+		auto it = explosions.begin();
+		while (it != explosions.end())
+		{
+			(*it)->setCurrTime(state->getElapsedTime());
+			if ((*it)->getCurrTime() >= (*it)->getStartTime() + 16.0f /* frames */ * 0.1f /* duration */)
+			{
+				delete *it;
+				it = explosions.erase(it);
+			} // if
+			else
+				it++;
+		} // while
+	}
 
 	// ****************************************
 
-	if (towerCamOn) // tower static camera
-	{
-		cam->setPos(TOWER_CAM_POS);
-		cam->setDir(TOWER_CAM_DIR);
-		cam->setUp(TOWER_CAM_UP);
-		cam->setVMatrix(cam->getPos(), cam->getPos() + cam->getDir(), cam->getUp());
-	} // if
-	else if (runwayCamOn) // runway static camera
 	{
-		cam->setPos(RUNWAY_CAM_POS);
-		cam->setDir(RUNWAY_CAM_DIR);
-		cam->setUp(RUNWAY_CAM_UP);
-		cam->setVMatrix(cam->getPos(), cam->getPos() + cam->getDir(), cam->getUp());
-	} // else if
-	else if (helicopterCamOn) // helicopter dynamic camera
+		ProfileScope scope("camera");
+
+		if (towerCamOn) // tower static camera
+		{
+			cam->setPos(TOWER_CAM_POS);
+			cam->setDir(TOWER_CAM_DIR);
+			cam->setUp(TOWER_CAM_UP);
+			cam->setVMatrix(cam->getPos(), cam->getPos() + cam->getDir(), cam->getUp());
+		} // if
+		else if (runwayCamOn) // runway static camera
+		{
+			cam->setPos(RUNWAY_CAM_POS);
+			cam->setDir(RUNWAY_CAM_DIR);
+			cam->setUp(RUNWAY_CAM_UP);
+			cam->setVMatrix(cam->getPos(), cam->getPos() + cam->getDir(), cam->getUp());
+		} // else if
+		else if (helicopterCamOn && helicopter) // helicopter dynamic camera
+		{
+			cam->setPos(helicopter->getPos() - 4.0f * normalize(helicopter->getDir()) + vec3(0.0f, 0.5f, 0.0f));
+			cam->setDir(helicopter->getDir());
+			cam->setUp(Y_AXIS);
+			cam->setVMatrix(cam->getPos(), cam->getPos() + cam->getDir(), cam->getUp());
+		} // else if
+		else if (airportExhCamOn) // airport exhibition dynamic camera
+			cam->update(state, airportExhPath);
+		else // free or real camera
+		{
+			cam->updateAngle();
+
+			if (planeModeOn) // player is flying
+				cam->updatePosWhileFlying(state);
+			else // player is walking
+				cam->updatePosWhileWalking(state);
+		} // else
+	}
+
+	ProfileScope scope("matrices");
+	entities->updateMatrices(jobs); // everything moved in this step is rebuilt in batches spread over the workers
+} // SIMULATE
+
+// ========================================
+
+/** Copies everything what the renderer needs and hands it over. */
+void publishSnapshot(double time)
+{
+	Snapshot &snap = snapshots.getBack();
+
+	snap.time = time;
+	snap.sceneVersion = sceneVersion;
+
+	snap.state = *state;
+	snap.cam = *cam;
+	snap.dayOn = dayOn;
+	snap.flashlightOn = flashlightOn;
+	snap.mistOn = mistOn;
+	snap.planeModeOn = planeModeOn;
+	snap.view = towerCamOn ? VIEW_TOWER : (runwayCamOn ? VIEW_RUNWAY : VIEW_NONE);
+
+	// position and direction of flashlight
+	Object *plane = cam->getPlane();
+	if (planeModeOn && plane) // player is flying
 	{
-		cam->setPos(helicopter->getPos() - 4.0f * normalize(helicopter->getDir()) + vec3(0.0f, 0.5f, 0.0f));
-		cam->setDir(helicopter->getDir());
-		cam->setUp(Y_AXIS);
-		cam->setVMatrix(cam->getPos(), cam->getPos() + cam->getDir(), cam->getUp());
-	} // else if
-	else if (airportExhCamOn) // airport exhibition dynamic camera
-		cam->update(state, airportExhCurveData, airportExhCurveSize);
-	else // free or real camera
+		snap.flashlightPos = plane->getPos() + 2.0f * normalize(plane->getDir());
+		snap.flashlightDir = normalize(plane->getDir());
+	} // if
+	else // player is walking
 	{
-		cam->updateAngle();
-
-		if (planeModeOn) // player is flying
-			cam->updatePosWhileFlying(state);
-		else // player is walking
-			cam->updatePosWhileWalking(state);
+		snap.flashlightPos = cam->getPos();
+		snap.flashlightDir = cam->getDir();
 	} // else
 
 	// ****************************************
 
-	glutTimerFunc(REFRESH_INTERVAL, onTimer, 0); // register new callback
-	glutPostRedisplay(); // redraw the window
-} // ON TIMER
+	// vectors keep their memory, so copying does not allocate after the first steps
+	snap.store.copyFrom(*entities);
+
+	snap.helicopter.clear();
+	if (helicopter)
+		snap.helicopter.push_back(*static_cast<Helicopter*>(helicopter));
+
+	snap.planes.clear();
+	if (jetPlane)
+		snap.planes.push_back({*jetPlane, &jetPlaneModel});
+	if (fighterPlane)
+		snap.planes.push_back({*fighterPlane, &fighterPlaneModel});
+	if (retroPlane)
+		snap.planes.push_back({*retroPlane, &retroPlaneModel});
+
+	snap.explosions.clear();
+	for (auto it : explosions)
+		snap.explosions.push_back(*static_cast<Explosion*>(it));
+
+	snap.gameOver.clear();
+	if (gameOver)
+		snap.gameOver.push_back(*static_cast<GameOver*>(gameOver));
+
+	traffic->collect(snap.traffic); // AI aircraft are drawn straight from the copied store
+	scheduler->collect(snap.traffic);
+	snap.trafficCount = traffic->getCount() + scheduler->getActiveCount();
+
+	// copies look into the copied store instead of the one the simulation keeps changing
+	for (auto &it : snap.helicopter)
+		it.setStore(&snap.store);
+	for (auto &it : snap.planes)
+		it.object.setStore(&snap.store);
+	for (auto &it : snap.explosions)
+		it.setStore(&snap.store);
+	for (auto &it : snap.gameOver)
+		it.setStore(&snap.store);
+
+	snapshots.publish();
+} // PUBLISH SNAPSHOT
 
 // ========================================
-// KEYBOARD MANAGEMENT
+
+void saveOldCamPos()
+{
+	if (!freeCamOn && !towerCamOn && !runwayCamOn && !helicopterCamOn && !airportExhCamOn) // switch from real camera to another
+	{
+		lastRealCamPos = cam->getPos();
+		lastRealCamAngleX = cam->getAngleX();
+		lastRealCamAngleY = cam->getAngleY();
+	} // if
+	else if (!realCamOn && !towerCamOn && !runwayCamOn && !helicopterCamOn && !airportExhCamOn) // switch from free camera to another
+	{
+		lastFreeCamPos = cam->getPos();
+		lastFreeCamAngleX = cam->getAngleX();
+		lastFreeCamAngleY = cam->getAngleY();
+	} // else if
+} // SAVE OLD CAM POS
+
 // ========================================
 
-void onKeyPressed(unsigned char key, int x, int y)
+void applyKeyPressed(unsigned char key)
 {
 	switch (key)
 	{
-		case 27: // escape
-			glutLeaveMainLoop(); // finish processing events
-			break;
 		case 'r': case 'R': // restart
-			onClose();
-			createObjects();
+			deleteVehicles();
+			createVehicles();
 
 			// last positions of cameras
 			lastFreeCamPos = lastRealCamPos = CAM_DEF_POS;
@@ -576,6 +1363,10 @@ void onKeyPressed(unsigned char key, int x, int y)
 			// booleans
 			realCamOn = dayOn = true;
 			flashlightOn = mistOn = planeModeOn = freeCamOn = towerCamOn = runwayCamOn = helicopterCamOn = airportExhCamOn = false;
+			sceneVersion++;
+			break;
+		case 't': case 'T': // AI traffic
+			traffic->setTarget(traffic->getTarget() ? 0 : TRAFFIC_AIRCRAFT);
 			break;
 		default:
 			break;
@@ -587,7 +1378,7 @@ void onKeyPressed(unsigned char key, int x, int y)
 	switch (key)
 	{
 		case 13: // enter
-			planeModeOn = cam->interactWithPlane(&jetPlane, &fighterPlane, &retroPlane);
+			planeModeOn = cam->interactWithPlane(jetPlane, fighterPlane, retroPlane);
 			break;
 		case 'w': case 'W': // forward
 			state->setKeys(KEY_W, true);
@@ -609,21 +1400,24 @@ void onKeyPressed(unsigned char key, int x, int y)
 			break;
 		case 'f': case 'F': // flashlight
 			flashlightOn = !flashlightOn;
+			sceneVersion++;
 			break;
 		case 'l': case 'L': // day/night
 			dayOn = !dayOn;
+			sceneVersion++;
 			break;
 		case 'm': case 'M': // mist
 			mistOn = !mistOn;
+			sceneVersion++;
 			break;
 		default:
 			break;
 	} // switch
-} // ON KEY PRESSED
+} // APPLY KEY PRESSED
 
 // ========================================
 
-void onKeyReleased(unsigned char key, int x, int y)
+void applyKeyReleased(unsigned char key)
 {
 	switch (key)
 	{
@@ -648,29 +1442,11 @@ void onKeyReleased(unsigned char key, int x, int y)
 		default:
 			break;
 	} // switch
-} // ON KEY RELEASED
-
-// ========================================
-
-void saveOldCamPos()
-{
-	if (!freeCamOn && !towerCamOn && !runwayCamOn && !helicopterCamOn && !airportExhCamOn) // switch from real camera to another
-	{
-		lastRealCamPos = cam->getPos();
-		lastRealCamAngleX = cam->getAngleX();
-		lastRealCamAngleY = cam->getAngleY();
-	} // if
-	else if (!realCamOn && !towerCamOn && !runwayCamOn && !helicopterCamOn && !airportExhCamOn) // switch from free camera to another
-	{
-		lastFreeCamPos = cam->getPos();
-		lastFreeCamAngleX = cam->getAngleX();
-		lastFreeCamAngleY = cam->getAngleY();
-	} // else if
-} // SAVE OLD CAM POS
+} // APPLY KEY RELEASED
 
 // ========================================
 
-void onSpecialKeyPressed(int key, int x, int y)
+void applySpecialKeyPressed(int key)
 {
 	switch (key)
 	{
@@ -771,11 +1547,11 @@ void onSpecialKeyPressed(int key, int x, int y)
 		default:
 			break;
 	} // switch
-} // ON SPECIAL KEY PRESSED
+} // APPLY SPECIAL KEY PRESSED
 
 // ========================================
 
-void onSpecialKeyReleased(int key, int x, int y)
+void applySpecialKeyReleased(int key)
 {
 	switch (key)
 	{
@@ -794,14 +1570,339 @@ void onSpecialKeyReleased(int key, int x, int y)
 		default:
 			break;
 	} // switch
-} // ON SPECIAL KEY RELEASED
+} // APPLY SPECIAL KEY RELEASED
+
+// ========================================
+
+/** Turns the camera by the shift of the pointer from the screen center. */
+void applyMotion(int shiftX, int shiftY)
+{
+	if (state->isGameOver()) return; // not working when game is over
+
+	// ****************************************
+
+	if (shiftY != 0) // move with camera vertically
+	{
+		float angleY = cam->getAngleY() + CAMERA_SENSITIVITY * shiftY;
+		if (abs(angleY) < CAMERA_ANGLE_MAX) // check top and bottom limit
+			cam->setAngleY(angleY);
+	} // if
+
+	if (shiftX != 0) // move with camera horizontally
+	{
+		float angleX = cam->getAngleX() + CAMERA_SENSITIVITY * shiftX;
+		cam->setAngleX(angleX);
+	} // if
+} // APPLY MOTION
+
+// ========================================
+
+/** Replays one event of the window callbacks on the simulation thread. */
+void applyInput(const InputEvent &event)
+{
+	switch (event.type)
+	{
+		case INPUT_KEY_DOWN:
+			applyKeyPressed((unsigned char)event.key);
+			break;
+		case INPUT_KEY_UP:
+			applyKeyReleased((unsigned char)event.key);
+			break;
+		case INPUT_SPECIAL_DOWN:
+			applySpecialKeyPressed(event.key);
+			break;
+		case INPUT_SPECIAL_UP:
+			applySpecialKeyReleased(event.key);
+			break;
+		case INPUT_MOTION:
+			applyMotion(event.x, event.y);
+			break;
+		case INPUT_PICK:
+			onPick(event.id);
+			break;
+		case INPUT_RAY:
+		{
+			// everything opaque takes part, scenery only blocks the ray
+			vector <Object*> objects = {island, runway, tower, antenna, helicopter, jetPlane, fighterPlane, retroPlane};
+			objects.insert(objects.end(), hangars.begin(), hangars.end());
+			objects.insert(objects.end(), stones.begin(), stones.end());
+			objects.insert(objects.end(), lamps.begin(), lamps.end());
+			objects.insert(objects.end(), spotLights.begin(), spotLights.end());
+
+			onPick(castRay(objects, event.origin, event.dir));
+			break;
+		} // case
+		default:
+			break;
+	} // switch
+} // APPLY INPUT
+
+// ========================================
+
+/** Applies the inputs due before the next step and takes it, replayed runs get their inputs from the journal only. */
+void stepWorld()
+{
+	InputEvent event;
+
+	if (journal && journal->isReplaying())
+	{
+		while (inputs.pop(event)); // live input would change the run
+
+		while (journal->next(simSteps, event))
+			applyInput(event);
+	} // if
+	else
+		while (inputs.pop(event)) // apply everything what has come since the last step
+		{
+			if (journal)
+				journal->record(simSteps, event);
+
+			applyInput(event);
+		} // while
+
+	ProfileScope scope("step");
+	simulate();
+	simSteps++;
+} // STEP WORLD
+
+// ========================================
+
+/** Body of the simulation thread, it owns all objects except the static scenery. */
+void simLoop()
+{
+	profiler->nameThread("simulation");
+
+	double lastTime = simClock->getTime();
+	double accumulator = 0.0;
+
+	while (simRunning)
+	{
+		double time = simClock->getTime();
+		accumulator += std::min(time - lastTime, (double)MAX_FRAME_TIME); // long stall does not freeze the game with catching up
+		lastTime = time;
+
+		bool stepped = false;
+		while (accumulator >= SIM_STEP)
+		{
+			stepWorld();
+			accumulator -= SIM_STEP;
+			stepped = true;
+		} // while
+
+		if (stepped) // current state belongs to the moment the leftover time ago
+			publishSnapshot(time - accumulator);
+
+		simClock->wait(SIM_STEP - accumulator); // wait for the next step
+	} // while
+} // SIM LOOP
 
 // ========================================
 // MAIN
 // ========================================
 
+/** Renders the given number of frames without any window (one simulation step each) and prints how long they take. */
+int runOffscreen(int frames, int dumpEvery)
+{
+	offscreen = new OffscreenContext(WIN_WIDTH, WIN_HEIGHT);
+
+	if (!initialize(OGL_VER_MAJOR, OGL_VER_MINOR))
+		dieWithError("PGR INIT FAILED – REQUIRED OPENGL NOT SUPPORTED?");
+
+	offscreen->createScreen();
+	simClock = new ManualClock(); // the same frames in every run
+	init();
+
+	// resolution must not adapt to the measured times
+	deleteComponent(&scaler);
+	scaler = new Scaler(upscaleProg, FRAME_BUDGET, 1.0f, 1.0f);
+	onReshape(offscreen->getWidth(), offscreen->getHeight());
+
+	publishSnapshot(simClock->getTime());
+
+	// ****************************************
+
+	StepTimer timer;
+
+	for (int frame = 0; frame < frames; frame++)
+	{
+		simClock->wait(SIM_STEP);
+		stepWorld();
+		publishSnapshot(simClock->getTime());
+
+		double start = getWallTime();
+		onDisplay();
+		glFinish(); // frame counts only when it is really drawn
+		timer.add(getWallTime() - start);
+
+		if ((dumpEvery > 0) && (frame % dumpEvery == 0)) // pictures for image comparison
+		{
+			char filename[32];
+			snprintf(filename, sizeof(filename), "frame%05d.png", frame);
+
+			if (!offscreen->savePng(filename))
+				cerr << "CANNOT WRITE " << filename << endl;
+		} // if
+	} // for
+
+	// ****************************************
+
+	cout << "frames:             " << timer.getCount() << " at " << offscreen->getWidth() << "x" << offscreen->getHeight() << endl;
+	cout << "frames per second:  " << timer.getCount() / std::max(timer.getTotal(), 1e-9) << endl;
+	cout << "frame mean:         " << timer.getMean() * 1000.0 << " ms" << endl;
+	cout << "frame p50:          " << timer.getPercentile(50.0) * 1000.0 << " ms" << endl;
+	cout << "frame p95:          " << timer.getPercentile(95.0) * 1000.0 << " ms" << endl;
+	cout << "frame p99:          " << timer.getPercentile(99.0) * 1000.0 << " ms" << endl;
+	cout << "frame max:          " << timer.getMax() * 1000.0 << " ms" << endl;
+
+	onClose();
+	deleteComponent(&offscreen);
+
+	return 0;
+} // RUN OFFSCREEN
+
+// ========================================
+
+/** Steps the whole world without any window for the given seconds and prints how long the steps take. */
+int runHeadless(double seconds, double warp)
+{
+	jobs = new JobSystem();
+	entities = new EntityStore(MAX_ENTITIES);
+
+	profiler->nameThread("simulation");
+	createModels(); // without programs only the collision hierarchies are loaded
+	createWorld();
+
+	// zero warp does not wait at all
+	simClock = (warp > 0.0) ? (Clock*)new WallClock(warp) : new ManualClock();
+
+	// ****************************************
+
+	StepTimer timer;
+	size_t steps = (size_t)(seconds / SIM_STEP + 0.5);
+
+	double start = getWallTime(), lastTime = simClock->getTime();
+	double accumulator = 0.0;
+
+	while (timer.getCount() < steps) // the same loop as the simulation thread has
+	{
+		double time = simClock->getTime();
+		accumulator += std::min(time - lastTime, (double)MAX_FRAME_TIME);
+		lastTime = time;
+
+		while ((accumulator >= SIM_STEP) && (timer.getCount() < steps))
+		{
+			double stepStart = getWallTime();
+			stepWorld();
+			timer.add(getWallTime() - stepStart);
+
+			accumulator -= SIM_STEP;
+		} // while
+
+		simClock->wait(SIM_STEP - accumulator);
+	} // while
+
+	// ****************************************
+
+	double wall = getWallTime() - start;
+	double simulated = timer.getCount() * SIM_STEP;
+
+	cout << "simulated seconds:  " << simulated << " in " << wall << " s (warp " << simulated / wall << ")" << endl;
+	cout << "steps:              " << timer.getCount() << endl;
+	cout << "step mean:          " << timer.getMean() * 1000.0 << " ms" << endl;
+	cout << "step p50:           " << timer.getPercentile(50.0) * 1000.0 << " ms" << endl;
+	cout << "step p95:           " << timer.getPercentile(95.0) * 1000.0 << " ms" << endl;
+	cout << "step p99:           " << timer.getPercentile(99.0) * 1000.0 << " ms" << endl;
+	cout << "step max:           " << timer.getMax() * 1000.0 << " ms" << endl;
+	cout << "AI aircraft:        " << traffic->getCount() + scheduler->getActiveCount() << endl;
+	cout << "explosions:         " << explosions.size() << endl;
+
+	deleteWorld(); // the journal has no input, but the seeds and the length reproduce the run
+
+	return 0;
+} // RUN HEADLESS
+
+// ========================================
+
+/** Runs the runway scheduler alone for the given hours as fast as possible and prints what has happened. */
+int runSchedule(double hours)
+{
+	double start = getWallTime();
+
+	Scheduler schedule(nullptr, ARRIVALS_PER_HOUR, DEPARTS_PER_HOUR, schedulerSeed);
+	schedule.advance(hours * 3600.0);
+
+	double wall = getWallTime() - start;
+	const SchedulerStats &stats = schedule.getStats();
+	size_t finished = std::max(stats.arrivals + stats.departures, (size_t)1);
+
+	cout << "simulated hours:     " << hours << " in " << wall * 1000.0 << " ms" << endl;
+	cout << "events:              " << stats.events << endl;
+	cout << "arrivals:            " << stats.arrivals << endl;
+	cout << "departures:          " << stats.departures << endl;
+	cout << "still moving:        " << schedule.getActiveCount() << endl;
+	cout << "runway utilisation:  " << 100.0 * stats.runwayBusy / (hours * 3600.0) << " %" << endl;
+	cout << "max runway queue:    " << stats.maxRunwayQueue << endl;
+	cout << "mean runway delay:   " << stats.runwayDelay / finished << " s" << endl;
+	cout << "mean taxi delay:     " << stats.taxiDelay / finished << " s" << endl;
+
+	return 0;
+} // RUN SCHEDULE
+
+// ========================================
+
+/** Prepares recording or replaying of the input, the replayed run starts with the recorded seeds. */
+void openJournal(const string &mode, const string &filename)
+{
+	journalFile = filename;
+
+	if (mode == "--record")
+	{
+		journal = new InputJournal(trafficSeed, schedulerSeed);
+		return;
+	} // if
+
+	journal = new InputJournal();
+	if (!journal->load(filename))
+		dieWithError("CANNOT READ INPUT JOURNAL " + filename);
+
+	trafficSeed = journal->getTrafficSeed();
+	schedulerSeed = journal->getSchedulerSeed();
+} // OPEN JOURNAL
+
+// ========================================
+
 int main(int argc, char **argv)
 {
+	// --record file, --replay file or --profile file may come with any mode, the other arguments are left for the modes
+	int count = 1;
+	for (int i = 1; i < argc; i++)
+		if (((string(argv[i]) == "--record") || (string(argv[i]) == "--replay")) && (i + 1 < argc))
+		{
+			openJournal(argv[i], argv[i + 1]);
+			i++;
+		} // if
+		else if ((string(argv[i]) == "--profile") && (i + 1 < argc)) // trace and percentiles written at the end
+			traceFile = argv[++i];
+		else
+			argv[count++] = argv[i];
+
+	argc = count;
+	profiler = new Profiler(!traceFile.empty());
+	profiler->nameThread("render");
+	double replayed = (journal && journal->isReplaying()) ? journal->getSteps() * (double)SIM_STEP : 0.0; // length of the replayed run
+
+	// --schedule [hours] only runs the runway scheduler without any window
+	if ((argc > 1) && (string(argv[1]) == "--schedule"))
+		return runSchedule((argc > 2) ? atof(argv[2]) : 24.0);
+
+	// --headless [seconds] [warp] steps the world without any window (warp 0 runs as fast as possible, a replay lasts as recorded)
+	if ((argc > 1) && (string(argv[1]) == "--headless"))
+		return runHeadless((argc > 2) ? atof(argv[2]) : (replayed ? replayed : 60.0), (argc > 3) ? atof(argv[3]) : 0.0);
+
+	// --offscreen [frames] [dump every] renders without any window into a surfaceless context (optional PNG of every n-th frame)
+	if ((argc > 1) && (string(argv[1]) == "--offscreen"))
+		return runOffscreen((argc > 2) ? atoi(argv[2]) : (replayed ? (int)(replayed / SIM_STEP + 0.5) : 600), (argc > 3) ? atoi(argv[3]) : 0);
+
 	glutInit(&argc, argv); // init GLUT library
 
 	glutInitContextFlags(GLUT_FORWARD_COMPATIBLE);
@@ -819,7 +1920,7 @@ int main(int argc, char **argv)
 	glutMouseFunc(onMouse);
 	glutMotionFunc(onMotion);
 	glutPassiveMotionFunc(onMotion);
-	glutTimerFunc(REFRESH_INTERVAL, onTimer, 0);
+	glutIdleFunc(onIdle);
 	glutKeyboardFunc(onKeyPressed);
 	glutKeyboardUpFunc(onKeyReleased);
 	glutSpecialFunc(onSpecialKeyPressed);
@@ -829,10 +1930,16 @@ int main(int argc, char **argv)
 	if (!initialize(OGL_VER_MAJOR, OGL_VER_MINOR))
 		dieWithError("PGR INIT FAILED – REQUIRED OPENGL NOT SUPPORTED?");
 
+	simClock = new WallClock();
 	init();
 
+	publishSnapshot(simClock->getTime()); // the first picture is drawn from the initial state
+
+	simRunning = true;
+	simThread = thread(simLoop); // from now on only the simulation touches vehicles
+
 	glutSetCursor(GLUT_CURSOR_NONE); // hide pointer
-	glutWarpPointer(state->getWinW()/2, state->getWinH()/2); // bind pointer with screen center
+	glutWarpPointer(winW / 2, winH / 2); // bind pointer with screen center
 	glutMainLoop(); // start processing events
 
 	return 0;
@@ -226,3 +226,70 @@ void Mesh::createGameOverMesh(GLuint program)
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER); // set no repeat filter to texture
 	glBindTexture(GL_TEXTURE_2D, 0);
 } // CREATE GAME OVER MESH
+
+// ========================================
+
+void Mesh::createBoundBoxMesh(GLuint program)
+{
+	// create vao
+	glGenVertexArrays(1, &this->vao); // create name for array
+	glBindVertexArray(this->vao); // bind with array
+
+	// create vbo (skybox cube is a unit box too)
+	glGenBuffers(1, &this->vbo); // create name for buffer
+	glBindBuffer(GL_ARRAY_BUFFER, this->vbo); // bind with buffer
+	glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxData), skyboxData, GL_STATIC_DRAW); // store data
+
+	// transfer positions to vertex shader
+	GLint posLoc = glGetAttribLocation(program, VERT_POS_VAR);
+	glEnableVertexAttribArray(posLoc);
+	glVertexAttribPointer(posLoc, 3, GL_FLOAT, GL_FALSE, 0, 0);
+
+	// close binding with vao and vbo
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// set remaining parameters
+	this->numTriangles = 12;
+	this->texture      = 0;
+	this->ambient      = vec3(1.0f, 1.0f, 1.0f);
+	this->diffuse      = vec3(1.0f, 1.0f, 1.0f);
+	this->specular     = vec3(1.0f, 1.0f, 1.0f);
+	this->shininess    = 10.0f;
+} // CREATE BOUND BOX MESH
+
+// ========================================
+
+void Mesh::createImpostorMesh(GLuint program)
+{
+	// create vao
+	glGenVertexArrays(1, &this->vao); // create name for array
+	glBindVertexArray(this->vao); // bind with array
+
+	// create vbo (same quad as explosion)
+	glGenBuffers(1, &this->vbo); // create name for buffer
+	glBindBuffer(GL_ARRAY_BUFFER, this->vbo); // bind with buffer
+	glBufferData(GL_ARRAY_BUFFER, sizeof(explosionData), explosionData, GL_STATIC_DRAW); // store data
+
+	// transfer positions to vertex shader
+	GLint posLoc = glGetAttribLocation(program, VERT_POS_VAR);
+	glEnableVertexAttribArray(posLoc);
+	glVertexAttribPointer(posLoc, 3 /* size */, GL_FLOAT /* type */, GL_FALSE, 5 * sizeof(float) /* step */, nullptr /* first */);
+
+	// transfer texture coordinates to vertex shader
+	GLint texCooLoc = glGetAttribLocation(program, TEX_COO_VAR);
+	glEnableVertexAttribArray(texCooLoc);
+	glVertexAttribPointer(texCooLoc, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+
+	// close binding with vao and vbo
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// set remaining parameters (texture is owned by the impostor)
+	this->numTriangles = 4;
+	this->texture      = 0;
+	this->ambient      = vec3(1.0f, 1.0f, 1.0f);
+	this->diffuse      = vec3(1.0f, 1.0f, 1.0f);
+	this->specular     = vec3(1.0f, 1.0f, 1.0f);
+	this->shininess    = 10.0f;
+} // CREATE IMPOSTOR MESH
@@ -1,35 +1,103 @@
 #include "headers/object.h"
+#include "headers/bvh.h"
 #include "headers/data.h"
+#include "headers/hud.h"
+#include "headers/impostor.h"
 #include "headers/spline.h"
 
 // ========================================
 
+float Object::alpha = 1.0f;
+
+// ========================================
+
+/** Creates the entity in the global store, the object owns it until it is deleted. */
+Object::Object(vec3 pos, vec3 dir, vec3 size, vec3 boundBox, vec3 angle, float currSpeed, float maxSpeed, float accel, float startTime)
+: store(entities), owner(true), defPos(pos), defDir(dir), inBox(0.0f), defAngle(angle),
+	startTime(startTime), currTime(startTime), impostor(nullptr), bvh(nullptr), id(0)
+{
+	this->handle = this->store->create(this, pos, dir, size, boundBox, angle, currSpeed, maxSpeed, accel);
+} // CONSTRUCTOR
+
+// ========================================
+
+/** Copy looks at the same entity without owning it (e.g. in a snapshot, which sets its own store). */
+Object::Object(const Object &other)
+: store(other.store), handle(other.handle), owner(false), defPos(other.defPos), defDir(other.defDir), inBox(other.inBox), defAngle(other.defAngle),
+	startTime(other.startTime), currTime(other.currTime), impostor(other.impostor), bvh(other.bvh), id(other.id) {}
+
+// ========================================
+
+Object &Object::operator=(const Object &other)
+{
+	if (this == &other) return *this;
+
+	if (this->owner)
+		this->store->destroy(this->handle);
+
+	this->store = other.store;
+	this->handle = other.handle;
+	this->owner = false;
+
+	this->defPos = other.defPos;
+	this->defDir = other.defDir;
+	this->inBox = other.inBox;
+	this->defAngle = other.defAngle;
+	this->startTime = other.startTime;
+	this->currTime = other.currTime;
+	this->impostor = other.impostor;
+	this->bvh = other.bvh;
+	this->id = other.id;
+
+	return *this;
+} // OPERATOR =
+
+// ========================================
+
+Object::~Object()
+{
+	if (this->owner)
+		this->store->destroy(this->handle);
+} // DESTRUCTOR
+
+// ========================================
+
+EntityStore *Object::getStore()                   {return this->store;}
+void         Object::setStore(EntityStore *store) {this->store = store;}
+
+EntityHandle Object::getHandle()                  {return this->handle;}
+
+// ========================================
+
 vec3  Object::getDefPos()                   {return this->defPos;}
 void  Object::setDefPos(vec3 defPos)        {this->defPos = defPos;}
 
-vec3  Object::getPos()                      {return this->pos;}
-void  Object::setPos(vec3 pos)              {this->pos = pos;}
+vec3  Object::getPos()                      {return this->store->pos[this->handle.index];}
+void  Object::setPos(vec3 pos)              {this->store->pos[this->handle.index] = pos; this->store->dirty[this->handle.index] = 1;}
+
+vec3  Object::getDir()                      {return this->store->dir[this->handle.index];}
+void  Object::setDir(vec3 direction)        {this->store->dir[this->handle.index] = direction; this->store->dirty[this->handle.index] = 1;}
 
-vec3  Object::getDir()                      {return this->dir;}
-void  Object::setDir(vec3 direction)        {this->dir = direction;}
+vec3  Object::getSize()                     {return this->store->size[this->handle.index];}
+void  Object::setSize(vec3 size)            {this->store->size[this->handle.index] = size; this->store->dirty[this->handle.index] = 1;}
 
-vec3  Object::getSize()                     {return this->size;}
-void  Object::setSize(vec3 size)            {this->size = size;}
+vec3  Object::getBoundBox()                 {return this->store->boundBox[this->handle.index];}
+void  Object::setBoundBox(vec3 boundBox)    {this->store->boundBox[this->handle.index] = boundBox;}
 
-vec3  Object::getBoundBox()                 {return this->boundBox;}
-void  Object::setBoundBox(vec3 boundBox)    {this->boundBox = boundBox;}
+vec3  Object::getInBox()                    {return this->inBox;}
+void  Object::setInBox(vec3 inBox)          {this->inBox = inBox;}
 
-vec3  Object::getAngle()                    {return this->angle;}
-void  Object::setAngle(vec3 angle)          {this->angle = angle;}
+vec3  Object::getAngle()                    {return this->store->angle[this->handle.index];}
+void  Object::setAngle(vec3 angle)          {this->store->angle[this->handle.index] = angle; this->store->dirty[this->handle.index] = 1;}
 
-float Object::getCurrSpeed()                {return this->currSpeed;}
-void  Object::setCurrSpeed(float currSpeed) {this->currSpeed = currSpeed;}
+float Object::getCurrSpeed()                {return this->store->currSpeed[this->handle.index];}
+void  Object::setCurrSpeed(float currSpeed) {this->store->currSpeed[this->handle.index] = currSpeed;}
 
-float Object::getMaxSpeed()                 {return this->maxSpeed;}
-void  Object::setMaxSpeed(float maxSpeed)   {this->maxSpeed = maxSpeed;}
+float Object::getMaxSpeed()                 {return this->store->maxSpeed[this->handle.index];}
+void  Object::setMaxSpeed(float maxSpeed)   {this->store->maxSpeed[this->handle.index] = maxSpeed;}
 
-float Object::getAccel()                    {return this->accel;}
-void  Object::setAccel(float accel)         {this->accel = accel;}
+float Object::getAccel()                    {return this->store->accel[this->handle.index];}
+void  Object::setAccel(float accel)         {this->store->accel[this->handle.index] = accel;}
 
 float Object::getStartTime()                {return this->startTime;}
 void  Object::setStartTime(float startTime) {this->startTime = startTime;}
@@ -37,18 +105,123 @@ void  Object::setStartTime(float startTime) {this->startTime = startTime;}
 float Object::getCurrTime()                 {return this->currTime;}
 void  Object::setCurrTime(float currTime)   {this->currTime = currTime;}
 
+Impostor *Object::getImpostor()                   {return this->impostor;}
+void      Object::setImpostor(Impostor *impostor) {this->impostor = impostor;}
+
+Bvh      *Object::getBvh()                        {return this->bvh;}
+void      Object::setBvh(Bvh *bvh)                {this->bvh = bvh;}
+
+unsigned int Object::getId()                {return this->id;}
+void         Object::setId(unsigned int id) {this->id = id;}
+
+// ========================================
+
+/** Transforms the model into the world. */
+mat4 Object::transform(vec3 pos, vec3 dir, vec3 angle)
+{
+	mat4 mMatrix = translate(mat4(1.0f), pos);
+	mMatrix = rotate(mMatrix, radians(angle.z), Z_AXIS);
+	mMatrix = rotate(mMatrix, radians(angle.y), Y_AXIS);
+	mMatrix = rotate(mMatrix, radians(angle.x), X_AXIS);
+	mMatrix = scale(mMatrix, this->getSize());
+
+	return mMatrix;
+} // TRANSFORM
+
+// ========================================
+
+/** Returns the model matrix of the current simulation step (collisions, ray casting), it is built only after a change. */
+mat4 Object::getMMatrix()
+{
+	unsigned int i = this->handle.index;
+
+	if (this->store->dirty[i]) // not built by the last batch
+	{
+		this->store->world[i] = this->transform(this->getPos(), this->getDir(), this->getAngle());
+		this->store->normal[i] = getNormalMatrix(this->store->world[i]);
+		this->store->dirty[i] = 0;
+	} // if
+
+	return this->store->world[i];
+} // GET M MATRIX
+
+// ========================================
+
+/** Checks whether the object has moved during the last simulation step. */
+bool Object::isMoving()
+{
+	unsigned int i = this->handle.index;
+	EntityStore *s = this->store;
+
+	return (s->pos[i] != s->prevPos[i]) || (s->dir[i] != s->prevDir[i]) || (s->angle[i] != s->prevAngle[i]);
+} // IS MOVING
+
+// ========================================
+
+/** Blends the last two simulation steps, so drawing does not depend on the simulation rate. */
+mat4 Object::getMMatrix(float alpha)
+{
+	if (!this->isMoving()) // nothing to blend, cached matrix is used
+		return this->getMMatrix();
+
+	unsigned int i = this->handle.index;
+	EntityStore *s = this->store;
+
+	vec3 turn = s->angle[i] - s->prevAngle[i];
+	turn -= 360.0f * floor(turn / 360.0f + vec3(0.5f)); // rotate the shorter way
+
+	vec3 dir = mix(s->prevDir[i], s->dir[i], alpha);
+	if (length(dir) < 1e-4f)
+		dir = s->dir[i];
+
+	return this->transform(mix(s->prevPos[i], s->pos[i], alpha), dir, s->prevAngle[i] + alpha * turn);
+} // GET M MATRIX
+
+// ========================================
+
+/** Remembers the state before the next simulation step (the store does it for all entities at once). */
+void Object::saveState()
+{
+	unsigned int i = this->handle.index;
+
+	this->store->prevPos[i] = this->store->pos[i];
+	this->store->prevDir[i] = this->store->dir[i];
+	this->store->prevAngle[i] = this->store->angle[i];
+} // SAVE STATE
+
+// ========================================
+
+/** Computes the world bounding box of the collision box and the transformed mesh. */
+void Object::getBounds(vec3 &min, vec3 &max)
+{
+	min = this->getPos() - this->getBoundBox();
+	max = this->getPos() + this->getBoundBox();
+
+	if (!this->bvh || this->bvh->isEmpty()) return;
+
+	mat4 mMatrix = this->getMMatrix();
+	vec3 center = vec3(mMatrix * vec4(0.5f * (this->bvh->getMin() + this->bvh->getMax()), 1.0f));
+	vec3 half = 0.5f * (this->bvh->getMax() - this->bvh->getMin());
+	vec3 extent = abs(vec3(mMatrix[0])) * half.x + abs(vec3(mMatrix[1])) * half.y + abs(vec3(mMatrix[2])) * half.z;
+
+	min = glm::min(min, center - extent);
+	max = glm::max(max, center + extent);
+} // GET BOUNDS
+
 // ========================================
 
 /** Checks whether the player is nearby the object (e.g. plane). */
 bool Object::isPlayerNearby(vec3 myPos)
 {
-	const float x = abs(myPos.x - this->pos.x);
-	const float y = abs(myPos.y - this->pos.y);
-	const float z = abs(myPos.z - this->pos.z);
+	vec3 pos = this->getPos(), boundBox = this->getBoundBox();
+
+	const float x = abs(myPos.x - pos.x);
+	const float y = abs(myPos.y - pos.y);
+	const float z = abs(myPos.z - pos.z);
 
-	if ((x <= (this->boundBox.x + 0.5f)) &&
-		  (y <= (this->boundBox.y + 0.5f)) &&
-		  (z <= (this->boundBox.z + 0.5f)))
+	if ((x <= (boundBox.x + 0.5f)) &&
+		  (y <= (boundBox.y + 0.5f)) &&
+		  (z <= (boundBox.z + 0.5f)))
 		return true; // player is near the plane
 
 	return false; // player is too far
@@ -56,35 +229,48 @@ bool Object::isPlayerNearby(vec3 myPos)
 
 // ========================================
 
-/** Updates moving object on the curve. */
-void Object::update(State* state, const vec3* curveData, size_t curveSize)
+/** Updates moving object on the path, the speed is given in units per second. */
+void Object::update(SplinePath* path)
 {
-	float time = this->currSpeed * (this->currTime - this->startTime);
+	float distance = this->getCurrSpeed() * (this->currTime - this->startTime);
 
-	this->setPos(evaluateClosedCurve(curveData, curveSize, time));
-	this->setDir(normalize(evaluateClosedCurve_1stDerivative(curveData, curveSize, time)));
+	vec3 pos, dir;
+	path->getPosAndTangent(distance, pos, dir);
+
+	this->setPos(pos);
+	this->setDir(dir);
 } // UPDATE
 
 // ========================================
 
-void Object::draw(GLuint program, vector <Mesh*> &model, mat4 pMatrix, mat4 vMatrix, mat4 mMatrix)
+/** Draws the model or its impostor (or both while fading) with the final model matrix. */
+void Object::drawModel(GLuint program, vector <Mesh*> &model, mat4 pMatrix, mat4 vMatrix, mat4 mMatrix, mat4 nMatrix)
 {
-	glUseProgram(program);
+	float fade = 0.0f; // impostor part of the pixels
 
-	// transform model
-	mMatrix = translate(mMatrix, this->pos);
-	mMatrix = rotate(mMatrix, radians(this->angle.z), Z_AXIS);
-	mMatrix = rotate(mMatrix, radians(this->angle.y), Y_AXIS);
-	mMatrix = rotate(mMatrix, radians(this->angle.x), X_AXIS);
-	mMatrix = scale(mMatrix, this->size);
+	if (this->impostor)
+	{
+		vec3 eye = vec3(inverse(vMatrix)[3]);
+		fade = clamp((distance(eye, this->getPos()) - IMPOSTOR_DIST) / IMPOSTOR_FADE, 0.0f, 1.0f);
+
+		if (fade > 0.0f)
+			this->impostor->draw(mMatrix, this->id, fade, pMatrix, vMatrix);
+
+		if (fade >= 1.0f) return; // only impostor is visible
+	} // if
 
-	mat4 nMatrix = transpose(inverse(mat4(mMatrix[0], mMatrix[1], mMatrix[2], vec4(0.0f, 0.0f, 0.0f, 1.0f))));
+	// ****************************************
+
+	glUseProgram(program);
 
 	// send data to vertex shader
 	glUniformMatrix4fv(glGetUniformLocation(program, P_MAT_VAR), 1, GL_FALSE, value_ptr(pMatrix));
 	glUniformMatrix4fv(glGetUniformLocation(program, V_MAT_VAR), 1, GL_FALSE, value_ptr(vMatrix));
 	glUniformMatrix4fv(glGetUniformLocation(program, M_MAT_VAR), 1, GL_FALSE, value_ptr(mMatrix));
 	glUniformMatrix4fv(glGetUniformLocation(program, N_MAT_VAR), 1, GL_FALSE, value_ptr(nMatrix));
+	glUniform1f(glGetUniformLocation(program, FADE_VAR), fade);
+	glUniform1ui(glGetUniformLocation(program, OBJ_ID_VAR), this->id);
+	renderStats.addProgram(6);
 
 	for (size_t i = 0; i < model.size(); i++)
 	{
@@ -94,6 +280,8 @@ void Object::draw(GLuint program, vector <Mesh*> &model, mat4 pMatrix, mat4 vMat
 		glUniform1f(glGetUniformLocation(program, VERT_SHI_VAR), model[i]->getShininess());
 
 		glUniform1i(glGetUniformLocation(program, TEX_ON_VAR), 0);
+		renderStats.uniforms += 5;
+
 		if (model[i]->getTexture() != 0)
 		{
 			// draw texture
@@ -101,67 +289,44 @@ void Object::draw(GLuint program, vector <Mesh*> &model, mat4 pMatrix, mat4 vMat
 			glUniform1i(glGetUniformLocation(program, TEX_ON_VAR), 1);
 			glActiveTexture(GL_TEXTURE0);
 			glBindTexture(GL_TEXTURE_2D, model[i]->getTexture());
+			renderStats.uniforms++;
+			renderStats.addTexture();
 		} // if
 
 		// draw vertices
 		glBindVertexArray(model[i]->getVao());
 		glDrawElements(GL_TRIANGLES /* mode */, model[i]->getNumTriangles() * 3 /* count */, GL_UNSIGNED_INT /* type */, nullptr /* indices */);
 		glBindVertexArray(0);
+		renderStats.addDraw(GL_TRIANGLES, model[i]->getNumTriangles() * 3);
 
 		glBindTexture(GL_TEXTURE_2D, 0); // unbind texture
 	} // for
 
 	glUseProgram(0);
-} // DRAW
+} // DRAW MODEL
 
 // ========================================
 
-void Helicopter::draw(GLuint program, vector <Mesh*> &model, mat4 pMatrix, mat4 vMatrix, mat4 mMatrix)
+void Object::draw(GLuint program, vector <Mesh*> &model, mat4 pMatrix, mat4 vMatrix, mat4 mMatrix)
 {
-	glUseProgram(program);
-
-	// transform model
-	mMatrix = translate(mMatrix, this->pos);
-	mMatrix = alignObject(this->pos, this->dir, Y_AXIS);
-	mMatrix = rotate(mMatrix, radians(-25.0f), X_AXIS);
-	mMatrix = rotate(mMatrix, radians(-90.0f), Y_AXIS);
-	mMatrix = scale(mMatrix, this->size);
-
-	mat4 nMatrix = transpose(inverse(mat4(mMatrix[0], mMatrix[1], mMatrix[2], vec4(0.0f, 0.0f, 0.0f, 1.0f))));
-
-	// send data to vertex shader
-	glUniformMatrix4fv(glGetUniformLocation(program, P_MAT_VAR), 1, GL_FALSE, value_ptr(pMatrix));
-	glUniformMatrix4fv(glGetUniformLocation(program, V_MAT_VAR), 1, GL_FALSE, value_ptr(vMatrix));
-	glUniformMatrix4fv(glGetUniformLocation(program, M_MAT_VAR), 1, GL_FALSE, value_ptr(mMatrix));
-	glUniformMatrix4fv(glGetUniformLocation(program, N_MAT_VAR), 1, GL_FALSE, value_ptr(nMatrix));
+	mat4 world = this->getMMatrix(Object::alpha);
+	mat4 normal = this->isMoving() ? getNormalMatrix(world) : this->store->normal[this->handle.index]; // still objects reuse the cached one
 
-	for (size_t i = 0; i < model.size(); i++)
-	{
-		glUniform3fv(glGetUniformLocation(program, VERT_AMB_VAR), 1, value_ptr(model[i]->getAmbient()));
-		glUniform3fv(glGetUniformLocation(program, VERT_DIF_VAR), 1, value_ptr(model[i]->getDiffuse()));
-		glUniform3fv(glGetUniformLocation(program, VERT_SPE_VAR), 1, value_ptr(model[i]->getSpecular()));
-		glUniform1f(glGetUniformLocation(program, VERT_SHI_VAR), model[i]->getShininess());
-
-		glUniform1i(glGetUniformLocation(program, TEX_ON_VAR), 0);
-		if (model[i]->getTexture() != 0)
-		{
-			// draw texture
-			glUniform1i(glGetUniformLocation(program, TEX_SAM_VAR), 0);
-			glUniform1i(glGetUniformLocation(program, TEX_ON_VAR), 1);
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, model[i]->getTexture());
-		} // if
+	this->drawModel(program, model, pMatrix, vMatrix, mMatrix * world, getNormalMatrix(mMatrix) * normal);
+} // DRAW
 
-		// draw vertices
-		glBindVertexArray(model[i]->getVao());
-		glDrawElements(GL_TRIANGLES, model[i]->getNumTriangles() * 3, GL_UNSIGNED_INT, nullptr);
-		glBindVertexArray(0);
+// ========================================
 
-		glBindTexture(GL_TEXTURE_2D, 0); // unbind texture
-	} // for
+/** Aligns the helicopter with its flight direction. */
+mat4 Helicopter::transform(vec3 pos, vec3 dir, vec3 angle)
+{
+	mat4 mMatrix = alignObject(pos, dir, Y_AXIS);
+	mMatrix = rotate(mMatrix, radians(-25.0f), X_AXIS);
+	mMatrix = rotate(mMatrix, radians(-90.0f), Y_AXIS);
+	mMatrix = scale(mMatrix, this->getSize());
 
-	glUseProgram(0);
-} // DRAW
+	return mMatrix;
+} // TRANSFORM
 
 // ========================================
 
@@ -170,14 +335,15 @@ void Explosion::draw(GLuint program, vector <Mesh*> &model, mat4 pMatrix, mat4 v
 	glDisable(GL_DEPTH_TEST);
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_ONE /* rendered fragment */, GL_ONE /* fragment in frame buffer */);
+	glColorMaski(1, GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE); // keep objects under the explosion pickable
 	glUseProgram(program);
 
 	// inverse view rotation
 	mat4 explosionRotMat = transpose(mat4(vMatrix[0], vMatrix[1], vMatrix[2], vec4(0.0f, 0.0f, 0.0f, 1.0f)));
 
 	// transform model
-	mMatrix = translate(mMatrix, this->pos);
-	mMatrix = scale(mMatrix, this->size);
+	mMatrix = translate(mMatrix, this->getPos());
+	mMatrix = scale(mMatrix, this->getSize());
 	mMatrix = mMatrix * explosionRotMat; // explosion now face the camera
 
 	// send data to vertex shader
@@ -186,6 +352,7 @@ void Explosion::draw(GLuint program, vector <Mesh*> &model, mat4 pMatrix, mat4 v
 	glUniformMatrix4fv(glGetUniformLocation(program, M_MAT_VAR), 1, GL_FALSE, value_ptr(mMatrix));
 
 	glUniform1f(glGetUniformLocation(program, TIME_VAR), this->currTime - this->startTime);
+	renderStats.addProgram(4);
 
 	for (size_t i = 0; i < model.size(); i++)
 	{
@@ -193,21 +360,25 @@ void Explosion::draw(GLuint program, vector <Mesh*> &model, mat4 pMatrix, mat4 v
 		glUniform3fv(glGetUniformLocation(program, VERT_DIF_VAR), 1, value_ptr(model[i]->getDiffuse()));
 		glUniform3fv(glGetUniformLocation(program, VERT_SPE_VAR), 1, value_ptr(model[i]->getSpecular()));
 		glUniform1f(glGetUniformLocation(program, VERT_SHI_VAR), model[i]->getShininess());
+		renderStats.uniforms += 4;
 
 		// draw texture
 		glUniform1i(glGetUniformLocation(program, TEX_SAM_VAR), 0);
 		glActiveTexture(GL_TEXTURE0);
 		glBindTexture(GL_TEXTURE_2D, model[i]->getTexture());
+		renderStats.addTexture();
 
 		// draw vertices
 		glBindVertexArray(model[i]->getVao());
 		glDrawArrays(GL_TRIANGLE_STRIP /* mode */, 0 /* first */, model[i]->getNumTriangles() /* count */);
 		glBindVertexArray(0);
+		renderStats.addDraw(GL_TRIANGLE_STRIP, model[i]->getNumTriangles());
 
 		glBindTexture(GL_TEXTURE_2D, 0); // unbind texture
 	} // for
 
 	glUseProgram(0);
+	glColorMaski(1, GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 	glDisable(GL_BLEND);
 	glEnable(GL_DEPTH_TEST);
 } // DRAW
@@ -219,14 +390,15 @@ void GameOver::draw(GLuint program, vector <Mesh*> &model, mat4 pMatrix, mat4 vM
 	glDisable(GL_DEPTH_TEST);
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glColorMaski(1, GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
 	glUseProgram(program);
 
 	// inverse view rotation
 	mat4 gameOverRotMat = transpose(mat4(vMatrix[0], vMatrix[1], vMatrix[2], vec4(0.0f, 0.0f, 0.0f, 1.0f)));
 
 	// transform model
-	mMatrix = translate(mMatrix, this->pos);
-	mMatrix = scale(mMatrix, this->size);
+	mMatrix = translate(mMatrix, this->getPos());
+	mMatrix = scale(mMatrix, this->getSize());
 	mMatrix = mMatrix * gameOverRotMat; // game over now face the camera
 
 	// send data to vertex shader
@@ -235,6 +407,7 @@ void GameOver::draw(GLuint program, vector <Mesh*> &model, mat4 pMatrix, mat4 vM
 	glUniformMatrix4fv(glGetUniformLocation(program, M_MAT_VAR), 1, GL_FALSE, value_ptr(mMatrix));
 
 	glUniform1f(glGetUniformLocation(program, TIME_VAR), this->currTime - this->startTime);
+	renderStats.addProgram(4);
 
 	for (size_t i = 0; i < model.size(); i++)
 	{
@@ -242,21 +415,25 @@ void GameOver::draw(GLuint program, vector <Mesh*> &model, mat4 pMatrix, mat4 vM
 		glUniform3fv(glGetUniformLocation(program, VERT_DIF_VAR), 1, value_ptr(model[i]->getDiffuse()));
 		glUniform3fv(glGetUniformLocation(program, VERT_SPE_VAR), 1, value_ptr(model[i]->getSpecular()));
 		glUniform1f(glGetUniformLocation(program, VERT_SHI_VAR), model[i]->getShininess());
+		renderStats.uniforms += 4;
 
 		// draw texture
 		glUniform1i(glGetUniformLocation(program, TEX_SAM_VAR), 0);
 		glActiveTexture(GL_TEXTURE0);
 		glBindTexture(GL_TEXTURE_2D, model[i]->getTexture());
+		renderStats.addTexture();
 
 		// draw vertices
 		glBindVertexArray(model[i]->getVao());
 		glDrawArrays(GL_TRIANGLE_STRIP, 0, model[i]->getNumTriangles());
 		glBindVertexArray(0);
+		renderStats.addDraw(GL_TRIANGLE_STRIP, model[i]->getNumTriangles());
 
 		glBindTexture(GL_TEXTURE_2D, 0); // unbind texture
 	} // for
 
 	glUseProgram(0);
+	glColorMaski(1, GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 	glDisable(GL_BLEND);
 	glEnable(GL_DEPTH_TEST);
 } // DRAW
@@ -272,6 +449,7 @@ void Skybox::draw(GLuint program, vector <Mesh*> &model, mat4 pMatrix, mat4 vMat
 	glUniformMatrix4fv(glGetUniformLocation(program, P_MAT_VAR), 1, GL_FALSE, value_ptr(pMatrix));
 	glUniformMatrix4fv(glGetUniformLocation(program, V_MAT_VAR), 1, GL_FALSE, value_ptr(mat4(mat3(vMatrix)))); // remove translation
 	glUniformMatrix4fv(glGetUniformLocation(program, M_MAT_VAR), 1, GL_FALSE, value_ptr(mMatrix));
+	renderStats.addProgram(3);
 
 	for (size_t i = 0; i < model.size(); i++)
 	{
@@ -279,11 +457,13 @@ void Skybox::draw(GLuint program, vector <Mesh*> &model, mat4 pMatrix, mat4 vMat
 		glUniform1i(glGetUniformLocation(program, TEX_SAM_VAR), 0);
 		glActiveTexture(GL_TEXTURE0);
 		glBindTexture(GL_TEXTURE_CUBE_MAP, model[i]->getTexture());
+		renderStats.addTexture();
 
 		// draw vertices
 		glBindVertexArray(model[i]->getVao());
 		glDrawArrays(GL_TRIANGLES, 0, 36);
 		glBindVertexArray(0);
+		renderStats.addDraw(GL_TRIANGLES, 36);
 
 		glBindTexture(GL_TEXTURE_CUBE_MAP, 0); // unbind texture
 	} // for
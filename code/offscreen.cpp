@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "headers/offscreen.h"
+
+#if defined(OFFSCREEN_EGL)
+	#include <EGL/egl.h>
+	#include <EGL/eglext.h>
+#elif defined(OFFSCREEN_OSMESA)
+	#include <GL/osmesa.h>
+#endif
+
+using namespace pgr;
+
+// ========================================
+
+/** Creates and binds the context, GL functions have to be loaded afterwards. */
+OffscreenContext::OffscreenContext(int width, int height)
+{
+	this->width = width;
+	this->height = height;
+	this->display = this->context = nullptr;
+	this->buffer = nullptr;
+	this->screen = nullptr;
+
+#if defined(OFFSCREEN_EGL)
+
+	auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	EGLDisplay display = getPlatformDisplay ? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr) : EGL_NO_DISPLAY;
+
+	if ((display == EGL_NO_DISPLAY) || !eglInitialize(display, nullptr, nullptr))
+		dieWithError("SURFACELESS EGL DISPLAY NOT AVAILABLE");
+
+	const EGLint configAttribs[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+	const EGLint contextAttribs[] =
+	{
+		EGL_CONTEXT_MAJOR_VERSION, OGL_VER_MAJOR,
+		EGL_CONTEXT_MINOR_VERSION, OGL_VER_MINOR,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+
+	EGLConfig config;
+	EGLint numConfigs = 0;
+	eglBindAPI(EGL_OPENGL_API);
+
+	if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || (numConfigs == 0))
+		dieWithError("NO EGL CONFIG FOR OPENGL");
+
+	EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+	if ((context == EGL_NO_CONTEXT) || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+		dieWithError("EGL CONTEXT CREATION FAILED");
+
+	this->display = display;
+	this->context = context;
+
+#elif defined(OFFSCREEN_OSMESA)
+
+	const int attribs[] =
+	{
+		OSMESA_FORMAT, OSMESA_RGBA,
+		OSMESA_DEPTH_BITS, 24,
+		OSMESA_STENCIL_BITS, 8,
+		OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+		OSMESA_CONTEXT_MAJOR_VERSION, OGL_VER_MAJOR,
+		OSMESA_CONTEXT_MINOR_VERSION, OGL_VER_MINOR,
+		0
+	};
+
+	OSMesaContext context = OSMesaCreateContextAttribs(attribs, nullptr);
+	this->buffer = new unsigned char[4 * width * height];
+
+	if (!context || !OSMesaMakeCurrent(context, this->buffer, GL_UNSIGNED_BYTE, width, height))
+		dieWithError("OSMESA CONTEXT CREATION FAILED");
+
+	this->context = context;
+
+#else
+
+	dieWithError("BUILT WITHOUT OFFSCREEN BACKEND (DEFINE OFFSCREEN_EGL OR OFFSCREEN_OSMESA)");
+
+#endif
+} // CONSTRUCTOR
+
+// ========================================
+
+OffscreenContext::~OffscreenContext()
+{
+	delete this->screen;
+
+#if defined(OFFSCREEN_EGL)
+
+	eglMakeCurrent((EGLDisplay)this->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	eglDestroyContext((EGLDisplay)this->display, (EGLContext)this->context);
+	eglTerminate((EGLDisplay)this->display);
+
+#elif defined(OFFSCREEN_OSMESA)
+
+	OSMesaDestroyContext((OSMesaContext)this->context);
+
+#endif
+
+	delete[] this->buffer;
+} // DESTRUCTOR
+
+// ========================================
+
+int           OffscreenContext::getWidth()  {return this->width;}
+int           OffscreenContext::getHeight() {return this->height;}
+RenderTarget *OffscreenContext::getScreen() {return this->screen;}
+
+// ========================================
+
+void OffscreenContext::createScreen()
+{
+	if (!this->screen)
+		this->screen = new RenderTarget(this->width, this->height);
+} // CREATE SCREEN
+
+// ========================================
+
+static unsigned int updateCrc(unsigned int crc, const unsigned char *data, size_t size)
+{
+	static unsigned int table[256] = {0};
+	if (!table[1]) // built at the first use
+		for (unsigned int n = 0; n < 256; n++)
+		{
+			unsigned int c = n;
+			for (int k = 0; k < 8; k++)
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			table[n] = c;
+		} // for
+
+	for (size_t i = 0; i < size; i++)
+		crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+
+	return crc;
+} // UPDATE CRC
+
+// ========================================
+
+static void writeChunk(FILE *file, const char *type, const vector <unsigned char> &data)
+{
+	unsigned char length[4] = {(unsigned char)(data.size() >> 24), (unsigned char)(data.size() >> 16), (unsigned char)(data.size() >> 8), (unsigned char)data.size()};
+	unsigned int crc = updateCrc(0xFFFFFFFFu, (const unsigned char*)type, 4);
+	crc = ~updateCrc(crc, data.data(), data.size());
+	unsigned char check[4] = {(unsigned char)(crc >> 24), (unsigned char)(crc >> 16), (unsigned char)(crc >> 8), (unsigned char)crc};
+
+	fwrite(length, 1, 4, file);
+	fwrite(type, 1, 4, file);
+	fwrite(data.data(), 1, data.size(), file);
+	fwrite(check, 1, 4, file);
+} // WRITE CHUNK
+
+// ========================================
+
+/** Writes the color of the screen target into an uncompressed PNG (stored deflate blocks need no library). */
+bool OffscreenContext::savePng(const string &filename)
+{
+	if (!this->screen) return false;
+
+	size_t rowSize = 4 * this->width;
+	vector <unsigned char> pixels(rowSize * this->height);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, this->screen->getFbo());
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, this->width, this->height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+	// rows from the top, each one starts with filter type 0
+	vector <unsigned char> raw;
+	raw.reserve((rowSize + 1) * this->height);
+	for (int y = this->height - 1; y >= 0; y--)
+	{
+		raw.push_back(0);
+		raw.insert(raw.end(), pixels.begin() + y * rowSize, pixels.begin() + (y + 1) * rowSize);
+	} // for
+
+	// ****************************************
+
+	vector <unsigned char> data = {0x78, 0x01}; // zlib header
+	unsigned int a = 1, b = 0;
+
+	for (size_t pos = 0; pos < raw.size() || pos == 0; pos += 65535)
+	{
+		size_t size = std::min(raw.size() - pos, (size_t)65535);
+		bool last = pos + size >= raw.size();
+
+		data.insert(data.end(), {(unsigned char)last, (unsigned char)size, (unsigned char)(size >> 8), (unsigned char)~size, (unsigned char)(~size >> 8)});
+		data.insert(data.end(), raw.begin() + pos, raw.begin() + pos + size);
+
+		for (size_t i = pos; i < pos + size; i++)
+		{
+			a = (a + raw[i]) % 65521;
+			b = (b + a) % 65521;
+		} // for
+	} // for
+
+	unsigned int adler = (b << 16) | a;
+	data.insert(data.end(), {(unsigned char)(adler >> 24), (unsigned char)(adler >> 16), (unsigned char)(adler >> 8), (unsigned char)adler});
+
+	// ****************************************
+
+	FILE *file = fopen(filename.c_str(), "wb");
+	if (!file) return false;
+
+	const unsigned char signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+	fwrite(signature, 1, sizeof(signature), file);
+
+	vector <unsigned char> header =
+	{
+		(unsigned char)(this->width >> 24), (unsigned char)(this->width >> 16), (unsigned char)(this->width >> 8), (unsigned char)this->width,
+		(unsigned char)(this->height >> 24), (unsigned char)(this->height >> 16), (unsigned char)(this->height >> 8), (unsigned char)this->height,
+		8, 6, 0, 0, 0 // 8 bits per channel, RGBA, no interlacing
+	};
+
+	writeChunk(file, "IHDR", header);
+	writeChunk(file, "IDAT", data);
+	writeChunk(file, "IEND", vector <unsigned char>());
+
+	return fclose(file) == 0;
+} // SAVE PNG
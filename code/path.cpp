@@ -0,0 +1,259 @@
+#include <algorithm>
+
+#include "headers/path.h"
+#include "headers/simd.h"
+
+// ========================================
+
+/** Closed path goes through all points, open one from the second to the last but one. */
+SplinePath::SplinePath(const vec3 points[], size_t count, bool closed)
+{
+	if (count < (closed ? 1u : 4u)) // open segment needs a point before and after it
+		pgr::dieWithError("SPLINE PATH HAS TOO FEW POINTS");
+
+	this->closed = closed;
+	this->numSegments = closed ? count : count - 3;
+
+	// polynomial of each segment in Horner form
+	for (size_t i = 0; i < this->numSegments; i++)
+	{
+		const vec3 &p0 = closed ? points[(i + count - 1) % count] : points[i];
+		const vec3 &p1 = closed ? points[i] : points[i + 1];
+		const vec3 &p2 = closed ? points[(i + 1) % count] : points[i + 2];
+		const vec3 &p3 = closed ? points[(i + 2) % count] : points[i + 3];
+
+		this->coeffs.push_back(0.5f * (-p0 + 3.0f * p1 - 3.0f * p2 + p3));
+		this->coeffs.push_back(0.5f * (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3));
+		this->coeffs.push_back(0.5f * (p2 - p0));
+		this->coeffs.push_back(p1);
+	} // for
+
+	// ****************************************
+
+	// measure the path along short chords
+	size_t steps = this->numSegments * LENGTH_STEPS;
+	vector <float> distances(steps + 1, 0.0f);
+
+	vec3 last = this->evaluate(0.0f);
+	for (size_t i = 1; i <= steps; i++)
+	{
+		vec3 point = this->evaluate((float)i / LENGTH_STEPS);
+		distances[i] = distances[i - 1] + distance(last, point);
+		last = point;
+	} // for
+
+	this->length = distances[steps];
+
+	// invert the measured distances into parameters at uniform distances
+	size_t entries = this->numSegments * TABLE_STEPS;
+	this->tableStep = this->length / entries;
+	this->table.resize(entries + 1);
+
+	size_t j = 0;
+	for (size_t k = 0; k <= entries; k++)
+	{
+		float target = k * this->tableStep;
+		while ((j + 1 < steps) && (distances[j + 1] < target))
+			j++;
+
+		float chord = distances[j + 1] - distances[j];
+		float f = (chord > 0.0f) ? clamp((target - distances[j]) / chord, 0.0f, 1.0f) : 0.0f;
+		this->table[k] = (j + f) / LENGTH_STEPS;
+	} // for
+} // CONSTRUCTOR
+
+// ========================================
+
+bool        SplinePath::isClosed()       {return this->closed;}
+size_t      SplinePath::getNumSegments() {return this->numSegments;}
+float       SplinePath::getLength()      {return this->length;}
+const vec3 *SplinePath::getCoeffs()      {return this->coeffs.data();}
+
+// ========================================
+
+/** Splits the curve parameter into the segment and the parameter inside it. */
+void SplinePath::locate(float param, size_t &segment, float &t)
+{
+	param = clamp(param, 0.0f, (float)this->numSegments);
+	segment = std::min((size_t)param, this->numSegments - 1);
+	t = param - segment;
+} // LOCATE
+
+// ========================================
+
+/** Converts the travelled distance into the curve parameter in constant time. */
+float SplinePath::getParam(float distance)
+{
+	if (this->closed) // go round again
+		distance -= this->length * floor(distance / this->length);
+	else
+		distance = clamp(distance, 0.0f, this->length);
+
+	float x = distance / this->tableStep;
+	size_t k = std::min((size_t)x, this->table.size() - 2);
+
+	return mix(this->table[k], this->table[k + 1], x - k);
+} // GET PARAM
+
+// ========================================
+
+/** Returns the coefficients of the segment at the distance and the parameter inside it. */
+const vec3 *SplinePath::getSegment(float distance, float &t)
+{
+	size_t i;
+	this->locate(this->getParam(distance), i, t);
+
+	return &this->coeffs[4 * i];
+} // GET SEGMENT
+
+// ========================================
+
+vec3 SplinePath::evaluate(float param)
+{
+	size_t i; float t;
+	this->locate(param, i, t);
+
+	const vec3 *c = &this->coeffs[4 * i];
+	return ((c[0] * t + c[1]) * t + c[2]) * t + c[3];
+} // EVALUATE
+
+// ========================================
+
+vec3 SplinePath::evaluateDerivative(float param)
+{
+	size_t i; float t;
+	this->locate(param, i, t);
+
+	const vec3 *c = &this->coeffs[4 * i];
+	return (3.0f * c[0] * t + 2.0f * c[1]) * t + c[2];
+} // EVALUATE DERIVATIVE
+
+// ========================================
+
+vec3 SplinePath::evaluateSecondDerivative(float param)
+{
+	size_t i; float t;
+	this->locate(param, i, t);
+
+	const vec3 *c = &this->coeffs[4 * i];
+	return 6.0f * c[0] * t + 2.0f * c[1];
+} // EVALUATE SECOND DERIVATIVE
+
+// ========================================
+
+vec3 SplinePath::getPos(float distance)
+{
+	return this->evaluate(this->getParam(distance));
+} // GET POS
+
+// ========================================
+
+vec3 SplinePath::getTangent(float distance)
+{
+	return normalize(this->evaluateDerivative(this->getParam(distance)));
+} // GET TANGENT
+
+// ========================================
+
+/** Both at once, the segment is only looked up once. */
+void SplinePath::getPosAndTangent(float distance, vec3 &pos, vec3 &tangent)
+{
+	float t;
+	const vec3 *c = this->getSegment(distance, t);
+
+	pos = ((c[0] * t + c[1]) * t + c[2]) * t + c[3];
+	tangent = normalize((3.0f * c[0] * t + 2.0f * c[1]) * t + c[2]);
+} // GET POS AND TANGENT
+
+// ========================================
+
+/** Returns 1 / radius of the turn at the distance. */
+float SplinePath::getCurvature(float distance)
+{
+	float param = this->getParam(distance);
+	vec3 d1 = this->evaluateDerivative(param);
+	vec3 d2 = this->evaluateSecondDerivative(param);
+
+	float speed = glm::length(d1);
+	return (speed > 0.0f) ? glm::length(cross(d1, d2)) / (speed * speed * speed) : 0.0f;
+} // GET CURVATURE
+
+// ========================================
+
+void PathBatch::resize(size_t count)
+{
+	this->paths.resize(count, nullptr);
+	this->distances.resize(count, 0.0f);
+
+	for (auto it : {&this->posX, &this->posY, &this->posZ, &this->dirX, &this->dirY, &this->dirZ})
+		it->resize(count, 0.0f);
+} // RESIZE
+
+// ========================================
+
+size_t PathBatch::getCount() {return this->paths.size();}
+
+// ========================================
+
+/** Evaluates the range four points at a time, only the segment lookup is done point by point. */
+void PathBatch::evaluate(size_t begin, size_t end)
+{
+	alignas(16) float in[13][4]; // a, b, c, d of the segments by components, parameter inside the segment
+	alignas(16) float out[6][4]; // position and tangent by components
+
+	for (size_t first = begin; first < end; first += 4)
+	{
+		size_t count = std::min(end - first, (size_t)4);
+
+		for (size_t lane = 0; lane < 4; lane++)
+		{
+			size_t i = first + std::min(lane, count - 1); // missing lanes repeat the last point
+
+			float t;
+			const vec3 *c = this->paths[i]->getSegment(this->distances[i], t);
+
+			for (int k = 0; k < 4; k++)
+			{
+				in[3 * k][lane] = c[k].x;
+				in[3 * k + 1][lane] = c[k].y;
+				in[3 * k + 2][lane] = c[k].z;
+			} // for
+
+			in[12][lane] = t;
+		} // for
+
+		// ****************************************
+
+		Float4 t(in[12]), dir[3] = {0.0f, 0.0f, 0.0f};
+
+		for (int k = 0; k < 3; k++)
+		{
+			Float4 a(in[k]), b(in[3 + k]), c(in[6 + k]), d(in[9 + k]);
+
+			(((a * t + b) * t + c) * t + d).store(out[k]);
+			dir[k] = (Float4(3.0f) * a * t + Float4(2.0f) * b) * t + c;
+		} // for
+
+		Float4 invLength = safeRcp(sqrt4(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]));
+		for (int k = 0; k < 3; k++)
+			(dir[k] * invLength).store(out[3 + k]);
+
+		// ****************************************
+
+		for (size_t lane = 0; lane < count; lane++)
+		{
+			size_t i = first + lane;
+
+			this->posX[i] = out[0][lane]; this->posY[i] = out[1][lane]; this->posZ[i] = out[2][lane];
+			this->dirX[i] = out[3][lane]; this->dirY[i] = out[4][lane]; this->dirZ[i] = out[5][lane];
+		} // for
+	} // for
+} // EVALUATE
+
+// ========================================
+
+/** Splits the whole batch among the workers, paths are only read, so the chunks do not interfere. */
+void PathBatch::evaluate(JobSystem *jobs)
+{
+	jobs->parallelFor(this->getCount(), GRAIN, [this](size_t begin, size_t end) {this->evaluate(begin, end);});
+} // EVALUATE
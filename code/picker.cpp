@@ -0,0 +1,92 @@
+#include "pgr.h"
+#include "headers/picker.h"
+
+// ========================================
+
+Picker::Picker()
+{
+	this->fence = nullptr;
+	this->requested = false;
+	this->x = this->y = 0;
+
+	// buffer for one object id
+	glGenBuffers(1, &this->pbo);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, this->pbo);
+	glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(GLuint), nullptr, GL_STREAM_READ);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+} // CONSTRUCTOR
+
+// ========================================
+
+Picker::~Picker()
+{
+	if (this->fence)
+		glDeleteSync(this->fence);
+
+	glDeleteBuffers(1, &this->pbo);
+} // DESTRUCTOR
+
+// ========================================
+
+/** Checks whether some click is still waiting for its result. */
+bool Picker::isBusy()
+{
+	return this->requested || this->fence;
+} // IS BUSY
+
+// ========================================
+
+/** Remembers the click, it is read after the next rendered frame. */
+void Picker::request(int x, int y)
+{
+	if (this->isBusy()) return; // one click at a time
+
+	this->requested = true;
+	this->x = x;
+	this->y = y;
+} // REQUEST
+
+// ========================================
+
+/** Starts copying the object id under the click into the pixel buffer without waiting. */
+void Picker::read(RenderTarget *target, float scale)
+{
+	if (!this->requested) return;
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, target->getFbo());
+	glReadBuffer(GL_COLOR_ATTACHMENT1);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, this->pbo);
+
+	// data go to the pixel buffer, CPU continues immediately
+	glReadPixels((GLint)(scale * this->x), (GLint)(scale * this->y), 1, 1, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+	this->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+	this->requested = false;
+} // READ
+
+// ========================================
+
+/** Returns the object id once GPU has finished the copy. */
+bool Picker::poll(unsigned int &id)
+{
+	if (!this->fence) return false;
+
+	GLenum status = glClientWaitSync(this->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0 /* do not wait */);
+	if ((status != GL_ALREADY_SIGNALED) && (status != GL_CONDITION_SATISFIED)) return false;
+
+	glDeleteSync(this->fence);
+	this->fence = nullptr;
+
+	// copy the object id from the pixel buffer
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, this->pbo);
+	GLuint *data = (GLuint*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof(GLuint), GL_MAP_READ_BIT);
+	id = data ? *data : 0;
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	return true;
+} // POLL
@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <cstdio>
+
+#include "headers/profiler.h"
+#include "headers/helpers.h"
+
+static thread_local string scopePath; // names of the open scopes of the thread joined by '/'
+static thread_local int threadId = -1;
+
+// ========================================
+
+RollingStats::RollingStats()
+{
+	this->next = 0;
+	this->samples.reserve(WINDOW);
+} // CONSTRUCTOR
+
+// ========================================
+
+size_t RollingStats::getCount() {return this->samples.size();}
+
+// ========================================
+
+float RollingStats::getLast()
+{
+	return this->samples.empty() ? 0.0f : this->samples[(this->next + WINDOW - 1) % WINDOW];
+} // GET LAST
+
+// ========================================
+
+float RollingStats::getPercentile(float percent)
+{
+	if (this->samples.empty()) return 0.0f;
+
+	vector <float> sorted = this->samples;
+	size_t k = std::min((size_t)(percent / 100.0f * sorted.size()), sorted.size() - 1);
+	nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+
+	return sorted[k];
+} // GET PERCENTILE
+
+// ========================================
+
+void RollingStats::add(float ms)
+{
+	if (this->samples.size() < WINDOW)
+		this->samples.push_back(ms);
+	else
+		this->samples[this->next] = ms;
+
+	this->next = (this->next + 1) % WINDOW;
+} // ADD
+
+// ========================================
+
+Profiler::Profiler(bool tracing)
+{
+	this->tracing = tracing;
+	this->origin = getWallTime();
+	this->numThreads = 0;
+
+	this->gpuReady = false;
+	this->gpuOffset = 0.0;
+	this->frame = 0;
+
+	for (int i = 0; i < GPU_FRAMES; i++)
+		this->gpuCount[i] = 0;
+
+	if (tracing)
+		this->trace.reserve(MAX_TRACE);
+} // CONSTRUCTOR
+
+// ========================================
+
+Profiler::~Profiler()
+{
+	if (this->gpuReady)
+		glDeleteQueries(GPU_FRAMES * GPU_SCOPES * 2, &this->queries[0][0][0]);
+} // DESTRUCTOR
+
+// ========================================
+
+bool   Profiler::isTracing() {return this->tracing;}
+double Profiler::getTime()   {return getWallTime() - this->origin;}
+
+// ========================================
+
+/** Numbers threads from 1 in the order they measure something. */
+int Profiler::getThreadId()
+{
+	if (threadId < 0)
+		threadId = ++this->numThreads;
+
+	return threadId;
+} // GET THREAD ID
+
+// ========================================
+
+void Profiler::nameThread(const string &name)
+{
+	int id = this->getThreadId();
+
+	lock_guard <mutex> guard(this->lock);
+	this->threadNames[id] = name;
+} // NAME THREAD
+
+// ========================================
+
+/** Creates timestamp queries and relates the GPU clock to the profiler one, a GL context has to be current. */
+void Profiler::initGpu()
+{
+	glGenQueries(GPU_FRAMES * GPU_SCOPES * 2, &this->queries[0][0][0]);
+
+	GLint64 gpuTime = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+	this->gpuOffset = this->getTime() - 1e-9 * gpuTime;
+
+	this->gpuReady = true;
+} // INIT GPU
+
+// ========================================
+
+/** Collects the oldest measured frame and starts measuring the new one. */
+void Profiler::beginFrame()
+{
+	if (!this->gpuReady) return;
+
+	this->frame = (this->frame + 1) % GPU_FRAMES;
+	this->readGpu(this->frame);
+	this->gpuCount[this->frame] = 0;
+} // BEGIN FRAME
+
+// ========================================
+
+/** Reads the timestamps of the frame when all of them are there, otherwise the frame is dropped (nobody waits for the GPU). */
+void Profiler::readGpu(int slot)
+{
+	int count = this->gpuCount[slot];
+	if (count == 0) return;
+
+	GLuint available = 0;
+	glGetQueryObjectuiv(this->queries[slot][count - 1][1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available) return;
+
+	lock_guard <mutex> guard(this->lock);
+
+	for (int i = 0; i < count; i++)
+	{
+		GLuint64 begin = 0, end = 0;
+		glGetQueryObjectui64v(this->queries[slot][i][0], GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(this->queries[slot][i][1], GL_QUERY_RESULT, &end);
+
+		double duration = 1e-9 * (double)(end - begin);
+		this->gpuStats[this->gpuPaths[slot][i]].add((float)(1000.0 * duration));
+
+		if (this->tracing && (this->trace.size() < MAX_TRACE))
+			this->trace.push_back({this->gpuNames[slot][i], 1e-9 * begin + this->gpuOffset, duration, 0});
+	} // for
+} // READ GPU
+
+// ========================================
+
+/** Puts the first timestamp of the scope into the command stream, returns its number for endGpu (-1 when not measured). */
+int Profiler::beginGpu(const char *name, const string &path)
+{
+	int slot = this->frame;
+	if (!this->gpuReady || (this->gpuCount[slot] >= GPU_SCOPES)) return -1;
+
+	int query = this->gpuCount[slot]++;
+	this->gpuNames[slot][query] = name;
+	this->gpuPaths[slot][query] = path;
+	glQueryCounter(this->queries[slot][query][0], GL_TIMESTAMP);
+
+	return query;
+} // BEGIN GPU
+
+// ========================================
+
+void Profiler::endGpu(int query)
+{
+	if (query >= 0)
+		glQueryCounter(this->queries[this->frame][query][1], GL_TIMESTAMP);
+} // END GPU
+
+// ========================================
+
+void Profiler::addCpu(const char *name, const string &path, double start, double end)
+{
+	int thread = this->getThreadId();
+
+	lock_guard <mutex> guard(this->lock);
+	this->cpuStats[path].add((float)(1000.0 * (end - start)));
+
+	if (this->tracing && (this->trace.size() < MAX_TRACE))
+		this->trace.push_back({name, start, end - start, thread});
+} // ADD CPU
+
+// ========================================
+
+/** Returns the last CPU duration of the scope in ms. */
+float Profiler::getLast(const string &path)
+{
+	lock_guard <mutex> guard(this->lock);
+
+	auto it = this->cpuStats.find(path);
+	return (it != this->cpuStats.end()) ? it->second.getLast() : 0.0f;
+} // GET LAST
+
+// ========================================
+
+vector <ScopeSummary> Profiler::getSummaries()
+{
+	lock_guard <mutex> guard(this->lock);
+	vector <ScopeSummary> summaries;
+
+	for (auto &it : this->cpuStats)
+	{
+		ScopeSummary summary = {it.first, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}};
+		auto gpu = this->gpuStats.find(it.first);
+
+		const float percents[3] = {50.0f, 95.0f, 99.0f};
+		for (int i = 0; i < 3; i++)
+		{
+			summary.cpu[i] = it.second.getPercentile(percents[i]);
+			if (gpu != this->gpuStats.end())
+				summary.gpu[i] = gpu->second.getPercentile(percents[i]);
+		} // for
+
+		summaries.push_back(summary);
+	} // for
+
+	return summaries; // ordered by path, so children follow their parents
+} // GET SUMMARIES
+
+// ========================================
+
+void Profiler::printSummary(ostream &out)
+{
+	char line[256];
+	snprintf(line, sizeof(line), "%-40s %8s %8s %8s %8s %8s %8s", "scope [ms]", "cpu p50", "cpu p95", "cpu p99", "gpu p50", "gpu p95", "gpu p99");
+	out << line << endl;
+
+	for (auto &it : this->getSummaries())
+	{
+		snprintf(line, sizeof(line), "%-40s %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f", it.path.c_str(), it.cpu[0], it.cpu[1], it.cpu[2], it.gpu[0], it.gpu[1], it.gpu[2]);
+		out << line << endl;
+	} // for
+} // PRINT SUMMARY
+
+// ========================================
+
+/** Writes complete events of the Chrome trace format (chrome://tracing or Perfetto can open it). */
+bool Profiler::writeTrace(const string &filename)
+{
+	FILE *file = fopen(filename.c_str(), "w");
+	if (!file) return false;
+
+	lock_guard <mutex> guard(this->lock);
+	fprintf(file, "{\"traceEvents\":[\n");
+	fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}");
+
+	for (auto &it : this->threadNames)
+		fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", it.first, it.second.c_str());
+
+	for (auto &it : this->trace) // names are literals of the code, nothing to escape
+		fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", it.name, it.thread, 1e6 * it.start, 1e6 * it.duration);
+
+	fprintf(file, "\n]}\n");
+	return fclose(file) == 0;
+} // WRITE TRACE
+
+// ========================================
+
+ProfileScope::ProfileScope(const char *name, bool gpu)
+{
+	this->name = name;
+	this->gpuQuery = -1;
+	if (!profiler) return;
+
+	this->pathLength = scopePath.size();
+	if (!scopePath.empty())
+		scopePath += '/';
+	scopePath += name;
+
+	if (gpu)
+		this->gpuQuery = profiler->beginGpu(name, scopePath);
+
+	this->start = profiler->getTime();
+} // CONSTRUCTOR
+
+// ========================================
+
+ProfileScope::~ProfileScope()
+{
+	if (!profiler) return;
+
+	double end = profiler->getTime();
+	profiler->endGpu(this->gpuQuery);
+	profiler->addCpu(this->name, scopePath, this->start, end);
+
+	scopePath.resize(this->pathLength);
+} // DESTRUCTOR
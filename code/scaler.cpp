@@ -0,0 +1,149 @@
+#include "pgr.h"
+#include "headers/scaler.h"
+#include "headers/data.h"
+#include "headers/hud.h"
+
+// ========================================
+
+Scaler::Scaler(GLuint program, float budget, float minScale, float maxScale)
+{
+	this->program = program;
+	this->budget = budget;
+	this->minScale = minScale;
+	this->maxScale = maxScale;
+	this->scale = maxScale;
+	this->gpuTime = 0.0f;
+	this->current = 0;
+	this->measuring = false;
+
+	glGenQueries(QUERIES, this->queries);
+	for (int i = 0; i < QUERIES; i++)
+	{
+		this->pending[i] = false;
+		this->scales[i] = maxScale;
+	} // for
+
+	glGenVertexArrays(1, &this->vao); // full screen triangle is generated in vertex shader
+} // CONSTRUCTOR
+
+// ========================================
+
+Scaler::~Scaler()
+{
+	glDeleteQueries(QUERIES, this->queries);
+	glDeleteVertexArrays(1, &this->vao);
+} // DESTRUCTOR
+
+// ========================================
+
+float Scaler::getScale()              {return this->scale;}
+
+float Scaler::getBudget()             {return this->budget;}
+void  Scaler::setBudget(float budget) {this->budget = budget;}
+
+float Scaler::getGpuTime()            {return this->gpuTime;}
+
+// ========================================
+
+/** Moves the scale towards the frame budget from the scale the time was measured with (older frames never correct twice). */
+void Scaler::adapt(float measuredScale, float time)
+{
+	if (time <= 0.0f) return;
+
+	// pixel count (not side) is proportional to time
+	float wanted = measuredScale * sqrt(this->budget / time);
+
+	if (wanted < measuredScale) // too slow, react quickly
+		this->scale = wanted;
+	else if (time < 0.85f * this->budget) // enough headroom, grow slowly
+		this->scale = glm::min(measuredScale + SCALE_STEP, wanted);
+	else
+		return;
+
+	// whole steps only, so a steady scale stays exactly the same
+	this->scale = clamp(floor(this->scale / SCALE_STEP) * SCALE_STEP, this->minScale, this->maxScale);
+} // ADAPT
+
+// ========================================
+
+/** Reads finished timer queries, every new result adapts the scale once. */
+void Scaler::update()
+{
+	for (int k = 0; k < QUERIES; k++)
+	{
+		int i = (this->current + k) % QUERIES; // oldest query first
+		if (!this->pending[i]) continue;
+
+		GLuint available = 0;
+		glGetQueryObjectuiv(this->queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) continue; // do not wait for GPU
+
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(this->queries[i], GL_QUERY_RESULT, &elapsed);
+		this->pending[i] = false;
+
+		this->gpuTime = 1e-6f * (float)elapsed;
+		this->adapt(this->scales[i], this->gpuTime);
+	} // for
+} // UPDATE
+
+// ========================================
+
+/** Starts measuring the scene on GPU. */
+void Scaler::begin()
+{
+	if (this->pending[this->current]) return; // GPU is too far behind, skip this frame
+
+	glBeginQuery(GL_TIME_ELAPSED, this->queries[this->current]);
+	this->pending[this->current] = true;
+	this->scales[this->current] = this->scale;
+	this->measuring = true;
+} // BEGIN
+
+// ========================================
+
+/** Stops measuring the scene on GPU. */
+void Scaler::end()
+{
+	if (!this->measuring) return; // measuring was skipped
+
+	glEndQuery(GL_TIME_ELAPSED);
+	this->measuring = false;
+	this->current = (this->current + 1) % QUERIES;
+} // END
+
+// ========================================
+
+/** Upscales the used part of the target to the window (or to another frame buffer) with a sharpening filter. */
+void Scaler::present(RenderTarget *target, int winW, int winH, GLuint screen)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, screen);
+	glViewport(0, 0, winW, winH);
+	glDisable(GL_DEPTH_TEST);
+
+	glUseProgram(this->program);
+
+	// send data to shaders
+	glUniform2fv(glGetUniformLocation(this->program, SCALE_VAR), 1, value_ptr(vec2(this->scale)));
+	glUniform2fv(glGetUniformLocation(this->program, TEXEL_VAR), 1, value_ptr(vec2(1.0f / target->getWidth(), 1.0f / target->getHeight())));
+	float sharpness = (this->minScale < 1.0f) ? SHARPNESS * (1.0f - this->scale) / (1.0f - this->minScale) : 0.0f; // fixed scale is never sharpened
+	glUniform1f(glGetUniformLocation(this->program, SHARP_VAR), sharpness);
+	renderStats.addProgram(3);
+
+	// draw texture
+	glUniform1i(glGetUniformLocation(this->program, TEX_SAM_VAR), 0);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, target->getColor());
+	renderStats.addTexture();
+
+	// draw vertices
+	glBindVertexArray(this->vao);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+	renderStats.addDraw(GL_TRIANGLES, 3);
+
+	glBindTexture(GL_TEXTURE_2D, 0); // unbind texture
+	glUseProgram(0);
+
+	glEnable(GL_DEPTH_TEST);
+} // PRESENT
@@ -0,0 +1,458 @@
+#include <algorithm>
+#include <cmath>
+
+#include "headers/scheduler.h"
+#include "headers/data.h"
+
+// wake category of each model (0 light, 1 medium, 2 heavy)
+static const int wakeCategories[TRAFFIC_TYPES_COUNT] = {2, 1, 0, 0};
+
+// seconds between the leader (row) leaving the runway and the follower (column) getting it
+static const double separations[3][3] =
+{
+	{ 60.0,  60.0, 60.0},
+	{120.0,  60.0, 60.0},
+	{180.0, 120.0, 90.0}
+};
+
+// height of the model above the ground when it stands on its wheels
+static const float groundHeights[TRAFFIC_TYPES_COUNT] = {0.6f, 0.81f, 0.5f, 0.6f};
+
+// ========================================
+
+/** Starts the arrival and departure streams, nothing happens before the first advance. */
+Scheduler::Scheduler(EntityStore *store, float arrivalRate, float departureRate, unsigned int seed)
+{
+	this->store = store;
+	this->now = 0.0;
+	this->sequence = 0;
+	this->seed = seed ? seed : 1; // zero would stay zero
+	this->arrivalRate = arrivalRate;
+	this->departureRate = departureRate;
+
+	this->runwayOccupant = -1;
+	this->lastRunwayType = -1;
+	this->runwayReleased = this->runwayGranted = this->runwayCheck = 0.0;
+	this->stats = SchedulerStats();
+
+	if (arrivalRate > 0.0f)
+		this->schedule(-log(1.0f - this->random()) * 3600.0f / arrivalRate, EVENT_SPAWN_ARRIVAL, -1);
+
+	if (departureRate > 0.0f)
+		this->schedule(-log(1.0f - this->random()) * 3600.0f / departureRate, EVENT_SPAWN_DEPARTURE, -1);
+} // CONSTRUCTOR
+
+// ========================================
+
+Scheduler::~Scheduler()
+{
+	if (!this->store) return;
+
+	for (auto it : this->active)
+		this->store->destroy(this->movements[it].handle);
+} // DESTRUCTOR
+
+// ========================================
+
+double                Scheduler::getTime()        {return this->now;}
+size_t                Scheduler::getActiveCount() {return this->active.size();}
+const SchedulerStats &Scheduler::getStats()       {return this->stats;}
+
+// ========================================
+
+/** Returns a pseudorandom number from <0, 1), the same seed always gives the same day. */
+float Scheduler::random()
+{
+	this->seed ^= this->seed << 13;
+	this->seed ^= this->seed >> 17;
+	this->seed ^= this->seed << 5;
+
+	return (this->seed >> 8) / 16777216.0f;
+} // RANDOM
+
+// ========================================
+
+void Scheduler::schedule(double time, int type, int movement)
+{
+	this->events.push({time, this->sequence++, type, movement});
+} // SCHEDULE
+
+// ========================================
+
+/** Returns the taxiway between the places, every direction is a separate lane. */
+int Scheduler::getSegment(int from, int to)
+{
+	auto it = this->segmentIds.find(make_pair(from, to));
+	if (it != this->segmentIds.end())
+		return it->second;
+
+	Segment segment = {from, to, -1, {}}; // free, nobody waits
+	this->segments.push_back(segment);
+	this->segmentIds[make_pair(from, to)] = (int)this->segments.size() - 1;
+
+	return (int)this->segments.size() - 1;
+} // GET SEGMENT
+
+// ========================================
+
+/** Final approach, landing roll and take off roll need the runway. */
+bool Scheduler::isRunwayLeg(const Movement &m, size_t leg)
+{
+	int from = m.route[leg], to = m.route[leg + 1];
+
+	return ((from == NODE_APPROACH) && (to == NODE_THRESHOLD)) ||
+		((from == NODE_THRESHOLD) && ((to == NODE_RUNWAY_EXIT) || (to == NODE_LIFT_OFF)));
+} // IS RUNWAY LEG
+
+// ========================================
+
+float Scheduler::getLegSpeed(const Movement &m, size_t leg)
+{
+	switch (m.route[leg])
+	{
+		case NODE_APPROACH:
+			return APPROACH_SPEED;
+		case NODE_THRESHOLD:
+			return ROLL_SPEED;
+		case NODE_LIFT_OFF:
+			return CLIMB_SPEED;
+		default:
+			return TAXI_SPEED;
+	} // switch
+} // GET LEG SPEED
+
+// ========================================
+
+/** Creates a landing on the final approach or a take off at one of the hangars and schedules the next one. */
+void Scheduler::spawn(int kind)
+{
+	int id;
+	if (!this->freeMovements.empty())
+	{
+		id = this->freeMovements.back();
+		this->freeMovements.pop_back();
+	} // if
+	else
+	{
+		id = (int)this->movements.size();
+		this->movements.push_back(Movement());
+	} // else
+
+	// ****************************************
+
+	Movement &m = this->movements[id];
+	m.type = (unsigned char)std::min((int)(this->random() * TRAFFIC_HELICOPTER), TRAFFIC_HELICOPTER - 1); // planes only
+	m.kind = (unsigned char)kind;
+	m.leg = 0;
+	m.moving = false;
+	m.legStart = m.legEnd = m.waitStart = this->now;
+	m.segment = -1;
+	m.onRunway = false;
+	m.handle = EntityHandle();
+
+	// every lane of the taxiway leads north, so waiting aircraft can never block each other in a circle
+	bool first = this->random() < 0.5f;
+	if (kind == MOVEMENT_ARRIVAL)
+	{
+		m.route = {NODE_APPROACH, NODE_THRESHOLD, NODE_RUNWAY_EXIT, NODE_TAXIWAY_EXIT, NODE_JUNCTION_1};
+		if (first)
+			m.route.insert(m.route.end(), {NODE_JUNCTION_0, NODE_HANGAR_0});
+		else
+			m.route.push_back(NODE_HANGAR_1);
+	} // if
+	else
+	{
+		m.route = first ? vector <int> {NODE_HANGAR_0, NODE_JUNCTION_0} : vector <int> {NODE_HANGAR_1, NODE_JUNCTION_1, NODE_JUNCTION_0};
+		m.route.insert(m.route.end(), {NODE_HOLD_SHORT, NODE_THRESHOLD, NODE_LIFT_OFF, NODE_CLIMB});
+	} // else
+
+	this->active.push_back(id);
+	this->request(id);
+
+	// ****************************************
+
+	float rate = (kind == MOVEMENT_ARRIVAL) ? this->arrivalRate : this->departureRate;
+	this->schedule(this->now - log(1.0f - this->random()) * 3600.0f / rate, (kind == MOVEMENT_ARRIVAL) ? EVENT_SPAWN_ARRIVAL : EVENT_SPAWN_DEPARTURE, -1);
+} // SPAWN
+
+// ========================================
+
+/** Asks for whatever the next leg needs, the movement waits at its place until it is granted. */
+void Scheduler::request(int id)
+{
+	Movement &m = this->movements[id];
+	m.waitStart = this->now;
+
+	if (this->isRunwayLeg(m, m.leg))
+	{
+		if (m.onRunway) // landing roll follows the approach
+			this->startLeg(id);
+		else
+		{
+			this->runwayQueue.push_back(id);
+			this->stats.maxRunwayQueue = std::max(this->stats.maxRunwayQueue, this->runwayQueue.size());
+			this->checkRunway();
+		} // else
+
+		return;
+	} // if
+
+	if (m.route[m.leg] == NODE_LIFT_OFF) // nothing to wait for in the air
+	{
+		this->startLeg(id);
+		return;
+	} // if
+
+	// ****************************************
+
+	Segment &segment = this->segments[this->getSegment(m.route[m.leg], m.route[m.leg + 1])];
+	if ((segment.occupant < 0) || (segment.occupant == id)) // exit of the runway may have been reserved already
+	{
+		segment.occupant = id;
+		this->startLeg(id);
+	} // if
+	else
+		segment.waiting.push_back(id);
+} // REQUEST
+
+// ========================================
+
+/** Moves on along the next leg and lets go of what the previous one needed. */
+void Scheduler::startLeg(int id)
+{
+	Movement &m = this->movements[id];
+	bool runway = this->isRunwayLeg(m, m.leg);
+	int segment = (runway || (m.route[m.leg] == NODE_LIFT_OFF)) ? -1 : this->getSegment(m.route[m.leg], m.route[m.leg + 1]);
+
+	if (runway)
+		this->stats.runwayDelay += this->now - m.waitStart;
+	else
+		this->stats.taxiDelay += this->now - m.waitStart;
+
+	vec3 from = taxiNodeData[m.route[m.leg]], to = taxiNodeData[m.route[m.leg + 1]];
+	m.moving = true;
+	m.legStart = this->now;
+	m.legEnd = this->now + distance(from, to) / this->getLegSpeed(m, m.leg);
+	this->schedule(m.legEnd, EVENT_LEG_END, id);
+
+	if (this->store && !this->store->isAlive(m.handle)) // appears with its first leg
+	{
+		vec3 dir = normalize(to - from);
+		m.handle = this->store->create(nullptr, from, dir, vec3(getTrafficSize(m.type)), vec3(0.0f), getTrafficAngle(m.type, dir), 0.0f, 0.0f, 0.0f);
+	} // if
+
+	// ****************************************
+
+	// releasing may start other movements, so this one has to be finished first
+	int previous = m.segment;
+	bool leftRunway = m.onRunway && !runway;
+
+	m.segment = segment;
+	if (leftRunway)
+		m.onRunway = false;
+
+	if ((previous >= 0) && (previous != segment))
+		this->releaseSegment(previous);
+
+	if (leftRunway)
+		this->releaseRunway();
+} // START LEG
+
+// ========================================
+
+void Scheduler::finish(int id)
+{
+	Movement &m = this->movements[id];
+
+	if (m.kind == MOVEMENT_ARRIVAL)
+		this->stats.arrivals++;
+	else
+		this->stats.departures++;
+
+	if (this->store)
+		this->store->destroy(m.handle);
+
+	this->active.erase(find(this->active.begin(), this->active.end(), id));
+	this->freeMovements.push_back(id);
+
+	int segment = m.segment;
+	m.segment = -1;
+	if (segment >= 0)
+		this->releaseSegment(segment);
+} // FINISH
+
+// ========================================
+
+/** Hands the taxiway over to the first waiting movement. */
+void Scheduler::releaseSegment(int segment)
+{
+	Segment &s = this->segments[segment];
+	s.occupant = -1;
+
+	if (!s.waiting.empty())
+	{
+		s.occupant = s.waiting.front();
+		s.waiting.pop_front();
+		this->startLeg(s.occupant);
+	} // if
+
+	this->checkRunway(); // free exit may let an arrival land
+} // RELEASE SEGMENT
+
+// ========================================
+
+void Scheduler::releaseRunway()
+{
+	this->stats.runwayBusy += this->now - this->runwayGranted;
+	this->runwayReleased = this->now;
+	this->lastRunwayType = this->movements[this->runwayOccupant].type;
+	this->runwayOccupant = -1;
+
+	this->checkRunway();
+} // RELEASE RUNWAY
+
+// ========================================
+
+/** Gives the free runway to the next movement, arrivals go first when their exit is free, separation behind the last one is kept. */
+void Scheduler::checkRunway()
+{
+	if ((this->runwayOccupant >= 0) || this->runwayQueue.empty()) return;
+
+	int exit = this->getSegment(NODE_RUNWAY_EXIT, NODE_TAXIWAY_EXIT);
+	auto pick = this->runwayQueue.end();
+
+	for (auto it = this->runwayQueue.begin(); it != this->runwayQueue.end(); it++)
+		if ((this->movements[*it].kind == MOVEMENT_ARRIVAL) && (this->segments[exit].occupant < 0))
+		{
+			pick = it;
+			break;
+		} // if
+
+	if (pick == this->runwayQueue.end())
+		for (auto it = this->runwayQueue.begin(); it != this->runwayQueue.end(); it++)
+			if (this->movements[*it].kind == MOVEMENT_DEPARTURE)
+			{
+				pick = it;
+				break;
+			} // if
+
+	if (pick == this->runwayQueue.end()) return; // arrivals wait for their exit
+
+	// ****************************************
+
+	int id = *pick;
+	Movement &m = this->movements[id];
+
+	double earliest = this->runwayReleased;
+	if (this->lastRunwayType >= 0)
+		earliest += separations[wakeCategories[this->lastRunwayType]][wakeCategories[m.type]];
+
+	if (this->now < earliest) // come back when the wake is gone
+	{
+		if ((this->runwayCheck <= this->now) || (this->runwayCheck > earliest))
+		{
+			this->runwayCheck = earliest;
+			this->schedule(earliest, EVENT_RUNWAY_CHECK, -1);
+		} // if
+
+		return;
+	} // if
+
+	this->runwayQueue.erase(pick);
+	this->runwayOccupant = id;
+	this->runwayGranted = this->now;
+	m.onRunway = true;
+
+	if (m.kind == MOVEMENT_ARRIVAL) // the runway is never blocked by taxiing aircraft
+		this->segments[exit].occupant = id;
+
+	this->startLeg(id);
+} // CHECK RUNWAY
+
+// ========================================
+
+/** Puts the entity of the movement where it is at the current time. */
+void Scheduler::place(int id)
+{
+	Movement &m = this->movements[id];
+	if (!this->store->isAlive(m.handle)) return;
+
+	// ****************************************
+
+	unsigned int e = m.handle.index;
+	vec3 from = taxiNodeData[m.route[m.leg]];
+	vec3 pos = from;
+
+	if (m.moving)
+	{
+		vec3 to = taxiNodeData[m.route[m.leg + 1]];
+		float f = (m.legEnd > m.legStart) ? clamp((float)((this->now - m.legStart) / (m.legEnd - m.legStart)), 0.0f, 1.0f) : 1.0f;
+
+		pos = mix(from, to, f);
+		this->store->dir[e] = normalize(to - from);
+		this->store->angle[e] = getTrafficAngle(m.type, this->store->dir[e]);
+	} // if
+
+	this->store->pos[e] = pos + vec3(0.0f, groundHeights[m.type], 0.0f);
+	this->store->dirty[e] = 1;
+} // PLACE
+
+// ========================================
+
+/** Processes all events up to the time (in seconds), then places the aircraft for drawing. */
+void Scheduler::advance(double time)
+{
+	while (!this->events.empty() && (this->events.top().time <= time))
+	{
+		Event event = this->events.top();
+		this->events.pop();
+
+		this->now = event.time;
+		this->stats.events++;
+
+		switch (event.type)
+		{
+			case EVENT_SPAWN_ARRIVAL:
+				this->spawn(MOVEMENT_ARRIVAL);
+				break;
+			case EVENT_SPAWN_DEPARTURE:
+				this->spawn(MOVEMENT_DEPARTURE);
+				break;
+			case EVENT_LEG_END:
+			{
+				Movement &m = this->movements[event.movement];
+				m.leg++;
+				m.moving = false;
+
+				if (m.leg + 1 == m.route.size()) // at the hangar or in the air
+					this->finish(event.movement);
+				else
+					this->request(event.movement);
+				break;
+			} // case
+			case EVENT_RUNWAY_CHECK:
+				this->checkRunway();
+				break;
+			default:
+				break;
+		} // switch
+	} // while
+
+	this->now = std::max(this->now, time);
+
+	// ****************************************
+
+	if (this->store)
+		for (auto it : this->active)
+			this->place(it);
+} // ADVANCE
+
+// ========================================
+
+/** Adds store slots of the drawn movements to the lists of AI aircraft. */
+void Scheduler::collect(vector <unsigned int> instances[TRAFFIC_TYPES_COUNT])
+{
+	for (auto it : this->active)
+		if (this->store && this->store->isAlive(this->movements[it].handle))
+			instances[this->movements[it].type].push_back(this->movements[it].handle.index);
+} // COLLECT
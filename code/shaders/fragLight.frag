@@ -19,6 +19,8 @@ uniform bool dayOn;
 uniform bool flaOn;
 uniform bool mistOn;
 uniform bool texOn;
+uniform float fade;
+uniform uint objId;
 
 // inputs
 smooth in mat4 vMat_fs;
@@ -28,7 +30,17 @@ smooth in vec2 texCoo_fs;
 smooth in float mistFact_fs;
 
 // outputs
-out vec4 color;
+layout(location = 0) out vec4 color;
+layout(location = 1) out uint id;
+
+// ordered dither pattern
+const float bayer[16] = float[]
+(
+   0.0,  8.0,  2.0, 10.0,
+  12.0,  4.0, 14.0,  6.0,
+   3.0, 11.0,  1.0,  9.0,
+  15.0,  7.0, 13.0,  5.0
+);
 
 // ========================================
 
@@ -108,6 +120,13 @@ vec4 spotShine(Light light, vec3 vertPos, vec3 vertNor, vec3 vertAmb, vec3 vertD
 
 void main()
 {
+	// hand pixels over to the impostor while fading (see impostor.frag)
+	ivec2 pixel = ivec2(gl_FragCoord.xy) % 4;
+	if ((bayer[4 * pixel.y + pixel.x] + 0.5) / 16.0 < fade)
+		discard;
+
+	id = objId; // for picking
+
 	// set global lighting
   vec3 globalAmbient = vec3(0.25f);
 	vec4 lightedColor = vec4(vertAmb * globalAmbient, 0.0);
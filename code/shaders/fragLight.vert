@@ -7,10 +7,10 @@ uniform mat4 mMat;
 uniform mat4 nMat;
 uniform float mistDen;
 
-// inputs
-in vec3 vertPos;
-in vec3 vertNor;
-in vec2 texCoo;
+// inputs (same places as in instanced.vert, which draws from the same arrays)
+layout(location = 0) in vec3 vertPos;
+layout(location = 1) in vec3 vertNor;
+layout(location = 2) in vec2 texCoo;
 
 // outputs
 smooth out mat4 vMat_fs;
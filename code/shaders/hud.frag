@@ -0,0 +1,14 @@
+#version 400
+
+// inputs
+smooth in vec4 color_fs;
+
+// outputs
+out vec4 color;
+
+// ========================================
+
+void main()
+{
+  color = color_fs;
+} // MAIN
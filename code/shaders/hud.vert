@@ -0,0 +1,22 @@
+#version 400
+
+// uniforms
+uniform vec2 screen;
+
+// inputs
+in vec2 vertPos;
+in vec4 vertCol;
+
+// outputs
+smooth out vec4 color_fs;
+
+// ========================================
+
+void main()
+{
+  // pixels from the top left corner to normalized device coordinates
+  vec2 pos = vertPos / screen;
+  gl_Position = vec4(2.0 * pos.x - 1.0, 1.0 - 2.0 * pos.y, 0.0, 1.0); // set the vertex position
+
+  color_fs = vertCol;
+} // MAIN
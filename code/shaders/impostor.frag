@@ -0,0 +1,53 @@
+#version 400
+
+// uniforms
+uniform sampler2D texSam;
+uniform float frames;
+uniform float fade;
+uniform uint objId;
+uniform float mistCol;
+uniform bool dayOn;
+uniform bool mistOn;
+
+// inputs
+smooth in vec2 texCoo_fs;
+smooth in float mistFact_fs;
+flat in vec2 frame_fs; // view of the atlas (per instance when instanced)
+
+// outputs
+layout(location = 0) out vec4 color;
+layout(location = 1) out uint id;
+
+// ordered dither pattern
+const float bayer[16] = float[]
+(
+   0.0,  8.0,  2.0, 10.0,
+  12.0,  4.0, 14.0,  6.0,
+   3.0, 11.0,  1.0,  9.0,
+  15.0,  7.0, 13.0,  5.0
+);
+
+// ========================================
+
+void main()
+{
+  // keep only pixels not covered by the model (see fragLight.frag)
+  ivec2 pixel = ivec2(gl_FragCoord.xy) % 4;
+  if ((bayer[4 * pixel.y + pixel.x] + 0.5) / 16.0 >= fade)
+    discard;
+
+  // stay inside the view, linear filter must not bleed into neighbours
+  vec2 texCoords = (frame_fs + clamp(texCoo_fs, vec2(0.01), vec2(0.99))) / frames;
+  vec4 texel = texture(texSam, texCoords);
+  if (texel.a < 0.5)
+    discard;
+
+  id = objId; // for picking
+
+  vec4 lightedColor = vec4(texel.rgb * (dayOn ? 1.0 : 0.3), 1.0); // views are baked by day
+
+  if (mistOn)
+    color = mistFact_fs * lightedColor + (1 - mistFact_fs) * mistCol;
+  else
+    color = lightedColor;
+} // MAIN
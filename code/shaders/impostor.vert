@@ -0,0 +1,31 @@
+#version 400
+
+// uniforms
+uniform mat4 pMat;
+uniform mat4 vMat;
+uniform mat4 mMat;
+uniform vec2 frame;
+uniform float mistDen;
+
+// inputs
+in vec3 vertPos;
+in vec2 texCoo;
+
+// outputs
+smooth out vec2 texCoo_fs;
+smooth out float mistFact_fs;
+flat out vec2 frame_fs;
+
+// ========================================
+
+void main()
+{
+  gl_Position = pMat * vMat * mMat * vec4(vertPos, 1.0); // set the vertex position
+
+  // set mist factor
+  vec4 pos = vMat * mMat * vec4(vertPos, 1.0);
+  mistFact_fs = clamp(exp(-mistDen * abs(pos.z)), 0.0, 1.0);
+
+  texCoo_fs = texCoo;
+  frame_fs = frame;
+} // MAIN
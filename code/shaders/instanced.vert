@@ -0,0 +1,35 @@
+#version 400
+
+// uniforms
+uniform mat4 pMat;
+uniform mat4 vMat;
+uniform float mistDen;
+
+// inputs
+layout(location = 0) in vec3 vertPos;
+layout(location = 1) in vec3 vertNor;
+layout(location = 2) in vec2 texCoo;
+layout(location = 3) in mat4 instMat; // model matrix of the instance
+
+// outputs
+smooth out mat4 vMat_fs;
+smooth out vec3 vertPos_fs;
+smooth out vec3 vertNor_fs;
+smooth out vec2 texCoo_fs;
+smooth out float mistFact_fs;
+
+// ========================================
+
+void main()
+{
+	vec4 pos = vMat * instMat * vec4(vertPos, 1.0);
+	gl_Position = pMat * pos; // set the vertex position
+
+	// instances are scaled uniformly, so the model matrix turns normals as well
+	vertPos_fs = pos.xyz;
+	vertNor_fs = normalize((vMat * instMat * vec4(vertNor, 0.0)).xyz);
+
+	vMat_fs = vMat;
+	texCoo_fs = texCoo;
+	mistFact_fs = clamp(exp(-mistDen * abs(pos.z)), 0.0, 1.0);
+} // MAIN
@@ -0,0 +1,30 @@
+#version 400
+
+// uniforms
+uniform mat4 pMat;
+uniform mat4 vMat;
+uniform float mistDen;
+
+// inputs
+in vec3 vertPos;
+in vec2 texCoo;
+layout(location = 3) in mat4 instMat; // camera-facing quad of the instance
+layout(location = 7) in vec2 instFrame; // view of the atlas
+
+// outputs
+smooth out vec2 texCoo_fs;
+smooth out float mistFact_fs;
+flat out vec2 frame_fs;
+
+// ========================================
+
+void main()
+{
+  vec4 pos = vMat * instMat * vec4(vertPos, 1.0);
+  gl_Position = pMat * pos; // set the vertex position
+
+  mistFact_fs = clamp(exp(-mistDen * abs(pos.z)), 0.0, 1.0);
+
+  texCoo_fs = texCoo;
+  frame_fs = instFrame;
+} // MAIN
@@ -0,0 +1,11 @@
+#version 400
+
+// outputs
+out vec4 color;
+
+// ========================================
+
+void main()
+{
+  color = vec4(1.0); // only depth test matters
+} // MAIN
@@ -7,11 +7,13 @@ uniform samplerCube texSam;
 smooth in vec3 texCoo_fs;
 
 // outputs
-out vec4 color;
+layout(location = 0) out vec4 color;
+layout(location = 1) out uint id;
 
 // ========================================
 
 void main()
 {
 	color = texture(texSam, texCoo_fs);
+	id = 0u; // sky cannot be picked
 } // MAIN
@@ -0,0 +1,34 @@
+#version 400
+
+// uniforms
+uniform sampler2D texSam;
+uniform vec2 scale;
+uniform vec2 texel;
+uniform float sharpness;
+
+// inputs
+smooth in vec2 texCoo_fs;
+
+// outputs
+out vec4 color;
+
+// ========================================
+
+/** Samples only the part of the target the scene was rendered into. */
+vec3 fetch(vec2 texCoords)
+{
+  return texture(texSam, clamp(texCoords, 0.5 * texel, scale - 0.5 * texel)).rgb;
+} // FETCH
+
+// ========================================
+
+void main()
+{
+  vec2 texCoords = texCoo_fs * scale;
+
+  vec3 center = fetch(texCoords);
+  vec3 blur = 0.25 * (fetch(texCoords + vec2(texel.x, 0.0)) + fetch(texCoords - vec2(texel.x, 0.0)) +
+                      fetch(texCoords + vec2(0.0, texel.y)) + fetch(texCoords - vec2(0.0, texel.y)));
+
+  color = vec4(center + sharpness * (center - blur), 1.0); // unsharp mask
+} // MAIN
@@ -0,0 +1,15 @@
+#version 400
+
+// outputs
+smooth out vec2 texCoo_fs;
+
+// ========================================
+
+void main()
+{
+  // one triangle covering the whole screen
+  vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+  gl_Position = vec4(2.0 * pos - 1.0, 0.0, 1.0); // set the vertex position
+
+  texCoo_fs = pos;
+} // MAIN
@@ -0,0 +1,109 @@
+#include "pgr.h"
+#include "headers/target.h"
+
+using namespace pgr;
+
+// ========================================
+
+RenderTarget::RenderTarget(int width, int height)
+{
+	this->width = this->height = 0;
+
+	glGenFramebuffers(1, &this->fbo);
+	glGenTextures(1, &this->color);
+	glGenTextures(1, &this->ids);
+	glGenRenderbuffers(1, &this->depth);
+
+	this->resize(width, height);
+} // CONSTRUCTOR
+
+// ========================================
+
+RenderTarget::~RenderTarget()
+{
+	glDeleteFramebuffers(1, &this->fbo);
+	glDeleteTextures(1, &this->color);
+	glDeleteTextures(1, &this->ids);
+	glDeleteRenderbuffers(1, &this->depth);
+} // DESTRUCTOR
+
+// ========================================
+
+GLuint RenderTarget::getFbo()    {return this->fbo;}
+GLuint RenderTarget::getColor()  {return this->color;}
+GLuint RenderTarget::getIds()    {return this->ids;}
+GLuint RenderTarget::getDepth()  {return this->depth;}
+
+int    RenderTarget::getWidth()  {return this->width;}
+int    RenderTarget::getHeight() {return this->height;}
+
+// ========================================
+
+/** Reallocates all attachments for the new size (e.g. after the window is reshaped). */
+void RenderTarget::resize(int width, int height)
+{
+	if ((width == this->width) && (height == this->height)) return; // nothing changed
+
+	this->width = width;
+	this->height = height;
+
+	// color texture
+	glBindTexture(GL_TEXTURE_2D, this->color);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	// object id texture (for picking)
+	glBindTexture(GL_TEXTURE_2D, this->ids);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, width, height, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	// depth and stencil buffer
+	glBindRenderbuffer(GL_RENDERBUFFER, this->depth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	// connect everything to frame buffer
+	glBindFramebuffer(GL_FRAMEBUFFER, this->fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->color, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, this->ids, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, this->depth);
+
+	const GLenum buffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+	glDrawBuffers(2, buffers); // color and object id
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		dieWithError("Error while creating RENDER TARGET frame buffer.");
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+} // RESIZE
+
+// ========================================
+
+/** Copies color, object ids, depth and stencil into another target of the same format. */
+void RenderTarget::copy(RenderTarget *to, int width, int height)
+{
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, this->fbo);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, to->getFbo());
+
+	// color attachments must be copied one by one (integer ids cannot mix with colors)
+	const GLenum buffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+	for (int i = 0; i < 2; i++)
+	{
+		glReadBuffer(buffers[i]);
+		glDrawBuffers(1, &buffers[i]);
+		glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	} // for
+
+	glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, GL_NEAREST);
+
+	// restore default buffers of both targets
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glDrawBuffers(2, buffers);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+} // COPY
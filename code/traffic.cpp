@@ -0,0 +1,217 @@
+#include <algorithm>
+
+#include "headers/traffic.h"
+#include "headers/data.h"
+
+// ========================================
+
+/** Size, speed and the base rotation of each model. */
+struct TrafficType
+{
+	float size, speed;
+	float tilt, yaw; // model nose is turned into +z
+};
+
+static const TrafficType trafficTypes[TRAFFIC_TYPES_COUNT] =
+{
+	{2.5f, 24.0f, 0.0f, 0.0f}, // jet
+	{2.5f, 30.0f, 0.0f, 0.0f}, // fighter
+	{1.5f, 14.0f, 3.0f, 0.0f}, // retro (stands on its tail wheel)
+	{2.5f, HELICOPTER_SPEED, 0.0f, 90.0f} // helicopter (its nose points into -x)
+};
+
+// ========================================
+
+/** Part of the offset used along the route, arrivals line up with the runway and departures spread out after take off. */
+static float getSpread(int route, float progress)
+{
+	switch (route)
+	{
+		case ROUTE_ARRIVAL:
+			return clamp(1.0f - 1.5f * progress, 0.0f, 1.0f);
+		case ROUTE_DEPARTURE:
+			return clamp(1.5f * progress - 0.5f, 0.0f, 1.0f);
+		default:
+			return 1.0f;
+	} // switch
+} // GET SPREAD
+
+// ========================================
+
+float getTrafficSize(int type)
+{
+	return trafficTypes[type].size;
+} // GET TRAFFIC SIZE
+
+// ========================================
+
+/** Turns the nose of the model into the direction of flight (helicopters stay level). */
+vec3 getTrafficAngle(int type, vec3 dir)
+{
+	const TrafficType &t = trafficTypes[type];
+
+	float yaw = degrees(atan2(dir.x, dir.z));
+	float pitch = (type == TRAFFIC_HELICOPTER) ? 0.0f : -degrees(asin(clamp(dir.y, -1.0f, 1.0f)));
+
+	return vec3(t.tilt + pitch, t.yaw + yaw, 0.0f);
+} // GET TRAFFIC ANGLE
+
+// ========================================
+
+/** Fills the wanted number of aircraft at random places of their routes. */
+Traffic::Traffic(EntityStore *store, SplinePath *arrival, SplinePath *departure, SplinePath *holding, size_t target, unsigned int seed)
+{
+	this->store = store;
+	this->routes[ROUTE_ARRIVAL] = arrival;
+	this->routes[ROUTE_DEPARTURE] = departure;
+	this->routes[ROUTE_HOLDING] = holding;
+	this->target = target;
+	this->seed = seed ? seed : 1; // zero would stay zero
+
+	this->aircraft.reserve(store->getCapacity());
+	for (size_t i = 0; i < this->target; i++)
+		this->spawn(true);
+
+	this->batch.resize(this->aircraft.size());
+	this->move(0, this->aircraft.size());
+} // CONSTRUCTOR
+
+// ========================================
+
+Traffic::~Traffic()
+{
+	for (auto &it : this->aircraft)
+		this->store->destroy(it.handle);
+} // DESTRUCTOR
+
+// ========================================
+
+size_t Traffic::getTarget()              {return this->target;}
+void   Traffic::setTarget(size_t target) {this->target = target;}
+
+size_t Traffic::getCount()               {return this->aircraft.size();}
+
+// ========================================
+
+/** Returns a pseudorandom number from <0, 1), the same seed always gives the same traffic. */
+float Traffic::random()
+{
+	this->seed ^= this->seed << 13;
+	this->seed ^= this->seed >> 17;
+	this->seed ^= this->seed << 5;
+
+	return (this->seed >> 8) / 16777216.0f;
+} // RANDOM
+
+// ========================================
+
+/** Takes a slot of the store for a new aircraft at the start of its route (or anywhere on it). */
+void Traffic::spawn(bool anywhere)
+{
+	if (this->store->getCount() + TRAFFIC_RESERVE >= this->store->getCapacity()) return; // the rest is kept for the scheduler and the explosions
+
+	// ****************************************
+
+	Aircraft a;
+	float r = this->random();
+
+	a.type = (unsigned char)std::min((int)(this->random() * TRAFFIC_TYPES_COUNT), TRAFFIC_TYPES_COUNT - 1);
+	if ((a.type == TRAFFIC_HELICOPTER) || (r < 0.5f)) // helicopters do not need the runway
+		a.route = ROUTE_HOLDING;
+	else
+		a.route = (r < 0.75f) ? ROUTE_ARRIVAL : ROUTE_DEPARTURE;
+
+	SplinePath *path = this->routes[a.route];
+	a.end = path->isClosed() ? path->getLength() * (1 + (int)(this->random() * TRAFFIC_MAX_LAPS)) : path->getLength();
+	a.distance = anywhere ? this->random() * a.end : 0.0f;
+	a.speed = trafficTypes[a.type].speed * (0.9f + 0.2f * this->random());
+	a.offset = vec3((this->random() - 0.5f) * TRAFFIC_SPREAD, this->random() * TRAFFIC_STACK, (this->random() - 0.5f) * TRAFFIC_SPREAD);
+
+	// ****************************************
+
+	vec3 pos, dir;
+	path->getPosAndTangent(a.distance, pos, dir);
+	pos += getSpread(a.route, a.distance / path->getLength()) * a.offset;
+
+	// previous state is the same, so the first drawn step does not come from elsewhere
+	float size = getTrafficSize(a.type);
+	a.handle = this->store->create(nullptr, pos, dir, vec3(size), vec3(0.0f), getTrafficAngle(a.type, dir), a.speed, a.speed, 0.0f);
+
+	this->aircraft.push_back(a);
+} // SPAWN
+
+// ========================================
+
+void Traffic::retire(size_t i)
+{
+	this->store->destroy(this->aircraft[i].handle); // slot is reused by the next spawn
+
+	this->aircraft[i] = this->aircraft.back();
+	this->aircraft.pop_back();
+} // RETIRE
+
+// ========================================
+
+/** Places the range of aircraft on their routes, chunks write different slots, so they may run in parallel. */
+void Traffic::move(size_t begin, size_t end)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		this->batch.paths[i] = this->routes[this->aircraft[i].route];
+		this->batch.distances[i] = this->aircraft[i].distance;
+	} // for
+
+	this->batch.evaluate(begin, end);
+
+	// ****************************************
+
+	for (size_t i = begin; i < end; i++)
+	{
+		Aircraft &a = this->aircraft[i];
+		unsigned int e = a.handle.index;
+
+		float spread = getSpread(a.route, a.distance / this->batch.paths[i]->getLength());
+		vec3 dir = vec3(this->batch.dirX[i], this->batch.dirY[i], this->batch.dirZ[i]);
+
+		this->store->pos[e] = vec3(this->batch.posX[i], this->batch.posY[i], this->batch.posZ[i]) + spread * a.offset;
+		this->store->dir[e] = dir;
+		this->store->angle[e] = getTrafficAngle(a.type, dir);
+		this->store->dirty[e] = 1;
+	} // for
+} // MOVE
+
+// ========================================
+
+/** Advances all aircraft by one step, retires the landed and departed ones and spawns new ones. */
+void Traffic::update(float step, JobSystem *jobs)
+{
+	for (size_t i = this->aircraft.size(); i-- > 0;) // backwards, the swapped one has already moved
+	{
+		this->aircraft[i].distance += this->aircraft[i].speed * step;
+		if (this->aircraft[i].distance >= this->aircraft[i].end)
+			this->retire(i);
+	} // for
+
+	while (this->aircraft.size() > this->target)
+		this->retire(this->aircraft.size() - 1);
+
+	for (int i = 0; (i < TRAFFIC_SPAWN_RATE) && (this->aircraft.size() < this->target); i++)
+		this->spawn(false);
+
+	// ****************************************
+
+	this->batch.resize(this->aircraft.size());
+	jobs->parallelFor(this->aircraft.size(), PathBatch::GRAIN, [this](size_t begin, size_t end) {this->move(begin, end);});
+} // UPDATE
+
+// ========================================
+
+/** Lists store slots of all aircraft by their models (for instanced drawing). */
+void Traffic::collect(vector <unsigned int> instances[TRAFFIC_TYPES_COUNT])
+{
+	for (int i = 0; i < TRAFFIC_TYPES_COUNT; i++)
+		instances[i].clear();
+
+	for (auto &it : this->aircraft)
+		instances[it.type].push_back(it.handle.index);
+} // COLLECT